@@ -5,125 +5,195 @@
 	);
 
 	// Estados da FSM
-	localparam IDLE      = 2'b00,
-				RECEIVING   = 2'b01,
-				PROCESSING  = 2'b10,
-				SENDING     = 2'b11;
+	localparam IDLE      = 3'b000,
+				RECEIVING   = 3'b001,
+				PROCESSING  = 3'b010,
+				SENDING     = 3'b011,
+				LOADING     = 3'b100,
+				UNPACKING   = 3'b101,
+				SHIFTING    = 3'b110;
+
+	// Comando no pulso de start: janela inteira (início de linha), kernels ou
+	// um lote de colunas que entram na janela atual
+	localparam OP_NEW_ROW      = 3'b000,
+				OP_LOAD_KERNELS = 3'b001,
+				OP_NEXT_COLUMN  = 3'b010;
 
 	reg [2:0] state;
 
 	// Controles de sincronização
-	reg fpga_wait;      					// Indica se FPGA está pronto (1 = ocupado)
+	reg fpga_wait;      					// ACK: cópia do bit de sequência do último pedido atendido
 	reg [2:0] hps_ready_sync;
-	reg hps_ready_prev;  				// Adicionado registro para detecção de borda	 
 
 	// Controles de operação
 	reg [4:0] index;    					// Índice para matrizes (0-24)
+	reg [4:0] received;  				// Pixels já guardados em pixel_buf
+	reg [4:0] expected;  				// Pixels do comando: n x n ou colunas x n
+	reg [1:0] columns;   				// Resultados do comando (1 a 3)
+	reg [1:0] column;    				// Coluna do lote em processamento
+	reg new_row;
 	reg [2:0] op_code;
 	reg [1:0] matrix_size;
-	reg start_flag;
 
-	// Matrizes internas
+	// Matrizes internas (matrix_a é a janela deslizante, matrix_b e matrix_c os kernels)
 	reg [7:0] matrix_a [0:24];
 	reg signed [7:0] matrix_b [0:24];
 	reg signed [7:0] matrix_c [0:24];
-	reg signed [7:0] matrix_result [0:24];
+	reg [7:0] pixel_buf [0:26];  		// Pixels recebidos, três por palavra
+	reg [7:0] result_pixels [0:2];  	// Um byte por coluna do lote
 
 	// Interface com coprocessador
 	wire [199:0] matrix_a_flat, matrix_b_flat, matrix_c_flat;
 	wire [199:0] matrix_out;
 	wire done_signal;
 
-	// Decodificação de entrada
-	wire [7:0]  val_a     = data_in[7:0];
-	wire [7:0]  val_b     = data_in[15:8];
-	wire [2:0]  opcode_in = data_in[18:16];
-	wire [1:0]  size_in   = data_in[20:19];
-	wire [7:0]  val_c		 = data_in[28:21];
-	wire 			reset     = data_in[29];
-	wire        start_in  = data_in[30];
+	// Decodificação de entrada: palavra de start (comando) e palavras de dados
+	wire [2:0]  command_in = data_in[18:16];
+	wire [1:0]  size_in    = data_in[20:19];
+	wire [2:0]  opcode_in  = data_in[23:21];
+	wire [1:0]  columns_in = data_in[25:24];
+	wire [7:0]  val_b      = data_in[15:8];  	// Gx (LOADING)
+	wire [7:0]  val_c		  = data_in[28:21];  	// Gy (LOADING)
+	wire 			reset      = data_in[29];
+	wire        start_in   = data_in[30];
+
+	wire [2:0]  side_in    = size_in + 3'd2;   	// n do comando
+	wire [2:0]  side       = matrix_size + 3'd2;	// n da janela atual
 
-	integer i; // Variável de iteração para o loop for
+	// O resultado vira um pixel aqui: |Laplaciano| saturado ou o gradiente
+	wire signed [15:0] laplacian  = matrix_out[15:0];
+	wire [15:0]        lap_abs    = laplacian[15] ? -laplacian : laplacian;
+	wire [7:0]         out_pixel  = (op_code == 3'b110) ? ((lap_abs > 16'd255) ? 8'd255 : lap_abs[7:0]) : matrix_out[7:0];
+
+	integer i, r, c; // Variáveis de iteração para os loops for
 	 
 	 // Sincronização (ordem dos bits)
 	always @(posedge clk or posedge reset) begin
 		 if (reset) begin
 			  hps_ready_sync <= 3'b000;
-			  hps_ready_prev <= 1'b0;  										// Inicializado
 		 end else begin
 			  hps_ready_sync <= {hps_ready_sync[1:0], data_in[31]};  // Ordem correta
-			  hps_ready_prev <= hps_ready_sync[2];  					 	// Atualiza o valor anterior
 		 end
 	end
 	
-	// Detecção de borda
-   wire hps_ready_edge = hps_ready_sync[2] && !hps_ready_prev;
+	// Handshake de duas fases: o HPS inverte o bit 31 a cada palavra e há pedido
+	// enquanto ele difere do ACK; atender é copiar o bit para fpga_wait. Nos
+	// estados de cálculo o pedido só fica pendente, não se perde
+	wire hps_request = hps_ready_sync[2] != fpga_wait;
 
-	// FSM principal
+	// FSM principal. O reset só vem no início de cada filtro (load_kernels) e não
+	// zera a janela nem os kernels
 	always @(posedge clk or posedge reset) begin : main_fsm
 		if (reset) begin
 			state <= IDLE;
 			index <= 0;
+			received <= 0;
+			column <= 0;
 			fpga_wait <= 0;
-			for (i = 0; i < 25; i = i + 1) begin
-				matrix_a[i] <= 8'b0;
-				matrix_b[i] <= 8'b0;
-			end
 		end 
 		else begin
 			case (state)
+				// Só espera um comando (tratado depois do case)
 				IDLE: begin
-					if (start_in) begin
-						index       <= 0;
-						state  		<= RECEIVING;
-					end 
 				end
 
-				RECEIVING: begin 
-					if (hps_ready_edge) begin
-						op_code     <= opcode_in;
-						matrix_size <= size_in;
-						matrix_a[index] <= val_a;
+				// 25 palavras com Gx em [15:8] e Gy em [28:21]; kernels menores que 5x5
+				// chegam no canto superior esquerdo, como as janelas
+				LOADING: begin
+					if (hps_request) begin
+						fpga_wait <= hps_ready_sync[2];
 						matrix_b[index] <= val_b;
 						matrix_c[index] <= val_c;
 						index <= index + 1;
 						if (index == 24) begin
-							index       <= 0;
-							state <= PROCESSING;
-                  end
-               end
+							index <= 0;
+							state <= IDLE;
+						end
+					end
 				end
+
+				// Três pixels por palavra em [23:0]: a janela n x n linha a linha ou
+				// as colunas do lote, uma após a outra, de cima para baixo
+				RECEIVING: begin 
+					if (hps_request) begin
+						fpga_wait <= hps_ready_sync[2];
+						pixel_buf[received]     <= data_in[7:0];
+						pixel_buf[received + 1] <= data_in[15:8];
+						pixel_buf[received + 2] <= data_in[23:16];
+						received <= received + 3;
+						if (received + 3 >= expected)
+							state <= new_row ? UNPACKING : SHIFTING;
+					end
+				end
+
+				// Janela inteira para o canto superior esquerdo da matriz 5x5
+				UNPACKING: begin
+					for (r = 0; r < 5; r = r + 1) begin
+						for (c = 0; c < 5; c = c + 1) begin
+							if (r < side && c < side) matrix_a[r * 5 + c] <= pixel_buf[r * side + c];
+						end
+					end
+					state <= PROCESSING;
+				end
+
+				// Desloca a janela uma coluna para a esquerda e põe a coluna do lote em n - 1
+				SHIFTING: begin
+					for (i = 0; i < 25; i = i + 1) begin
+						if (i % 5 != 4) matrix_a[i] <= matrix_a[i + 1];
+					end
+					for (r = 0; r < 5; r = r + 1) begin
+						if (r < side) matrix_a[r * 5 + side - 1] <= pixel_buf[column * side + r];
+					end
+					state <= PROCESSING;
+				end
+
 				PROCESSING: begin
 					if (done_signal) begin
-						for (i = 0; i < 25; i = i + 1) begin
-							matrix_result[i] <= matrix_out[(i*8) +: 8];
-						end
-						index <= 0;
-						state <= SENDING;
+						result_pixels[column] <= out_pixel;
+						column <= column + 1;
+						state <= (column + 1 == columns) ? SENDING : SHIFTING;
 					end 
 				end
 
+				// Os resultados do lote vão numa única palavra: basta um pedido do HPS.
+				// Sem passar por IDLE, o próximo lote repete o último comando de colunas
 				SENDING: begin
-					// Detecção de borda de subida 
-					if (hps_ready_edge) begin
-						if (index == 25) begin
-							state <= IDLE;
-						end
-						index <= index + 1; 
+					if (hps_request) begin
+						fpga_wait <= hps_ready_sync[2];
+						received <= 0;
+						column   <= 0;
+						new_row  <= 0;
+						state    <= RECEIVING;
 					end
 				end
 			endcase
-			// Geração do sinal de sincronização
-			fpga_wait <= ((state == RECEIVING) || (state == SENDING)) && hps_ready_sync[2];
+			// Comando novo (pulso de start): em IDLE ou antes do primeiro pixel de um
+			// lote; o HPS só o manda quando muda de linha ou de número de colunas
+			if (start_in && (state == IDLE || (state == RECEIVING && received == 0))) begin
+				index       <= 0;
+				received    <= 0;
+				column      <= 0;
+				if (command_in == OP_LOAD_KERNELS)
+					state <= LOADING;
+				else begin
+					op_code     <= opcode_in;
+					matrix_size <= size_in;
+					new_row     <= (command_in == OP_NEW_ROW);
+					columns     <= (command_in == OP_NEW_ROW) ? 2'd1 : columns_in;
+					expected    <= (command_in == OP_NEW_ROW) ? side_in * side_in : columns_in * side_in;
+					state       <= RECEIVING;
+				end
+			end
 		end
 	end
 	
-	// Saídas - Bit 31 = fpga_ack, bits 7:0 = dados
+	// Saídas - Bit 31 = fpga_ack (igual ao bit 31 do HPS = pedido atendido), bits 25:24 = resultados válidos, bits 23:0 = até três pixels.
+	// Não depende do estado: o ACK só chega ao HPS depois que SENDING já saiu
 	always @(posedge clk or posedge reset) begin
 		if (reset) begin
 			data_out <= 32'b0;
 		end else begin
-			data_out <= {fpga_wait, 23'b0, (state == SENDING) ? matrix_result[index-1] : 8'b0};
+			data_out <= {fpga_wait, 5'b0, columns, result_pixels[2], result_pixels[1], result_pixels[0]};
 		end
 	end
 
@@ -0,0 +1,263 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "interface.h"
+#include "convolution.h"
+#include "hw_backend.h"
+#include "fpga_filter.h"
+#include "image.h"
+
+/* ========== VERIFICAÇÃO BYTE A BYTE (make check) ==========
+ *
+ * Compara com uma convolução janela a janela, sem nada do motor, as saídas
+ * de: conv_filter, conv_filter_bands (1 e 3 threads, faixas automáticas e de
+ * 4 linhas), conv_filter_multi_bands, conv_filter_multi_stream e
+ * fpga_filter_pass (o mesmo de main.c) sobre o simulador do ControlUnit.
+ * Cada filtro de filters.c passa pelas quatro bordas, e a saída é preenchida
+ * com CHECK_SENTINEL antes de cada caminho, para que um pixel não escrito
+ * não passe com o valor do caminho anterior. A implementação vetorial é a
+ * de CONV_SIMD, então o make check roda uma vez para cada uma.
+ */
+
+// Larguras que deixam sobra no fim da linha para 8, 16 e 32 pixels por iteração
+#define CHECK_WIDTH 53
+#define CHECK_HEIGHT 37
+#define CHECK_FILTERS 5
+// Valor das saídas antes de cada caminho (não é 0 nem 255, os mais comuns)
+#define CHECK_SENTINEL 0xA5
+
+typedef struct {
+    const char* name;
+    int8_t* gx;
+    int8_t* gy;
+    uint32_t size_code;
+    int8_t laplaciano;
+} check_filter_t;
+
+static int8_t kernel_zero[MATRIX_SIZE] = {0};
+
+static const check_filter_t check_filters[CHECK_FILTERS] = {
+    {"sobel_3x3",      sobel_gx_3x3,   sobel_gy_3x3,   1, 0},
+    {"sobel_5x5",      sobel_gx_5x5,   sobel_gy_5x5,   3, 0},
+    {"prewitt_3x3",    prewitt_gx_3x3, prewitt_gy_3x3, 1, 0},
+    {"roberts_2x2",    roberts_gx_2x2, roberts_gy_2x2, 0, 0},
+    {"laplaciano_5x5", laplaciano_5x5, kernel_zero,    3, 1}
+};
+
+static const conv_border_t check_borders[] = {
+    CONV_BORDER_ZERO, CONV_BORDER_REPLICATE, CONV_BORDER_REFLECT, CONV_BORDER_SKIP
+};
+#define CHECK_BORDERS (int)(sizeof(check_borders) / sizeof(check_borders[0]))
+
+static int check_cases = 0;
+static int check_failures = 0;
+
+/* ========== IMAGEM DE TESTE ========== */
+
+// Ruído fixo com blocos alternando 0 e 255: satura o gradiente e deixa o
+// Laplaciano negativo nas bordas dos blocos
+static void check_image_fill(image_t* img) {
+    uint32_t seed = 12345;
+    int x, y;
+
+    for (y = 0; y < img->height; y++) {
+        uint8_t* row = image_row(img, y);
+        for (x = 0; x < img->width; x++) {
+            seed = seed * 1103515245u + 12345u;
+            row[x] = (uint8_t)(seed >> 24);
+            if ((x / 6 + y / 5) % 3 == 0) row[x] = ((x + y) & 1) ? 255 : 0;
+        }
+    }
+}
+
+/* ========== REFERÊNCIA JANELA A JANELA ========== */
+
+// Coordenada j em [0, n) conforme a borda (-1 fora da imagem em zero e skip)
+static int check_index(int j, int n, conv_border_t border) {
+    if (j >= 0 && j < n) return j;
+    if (border == CONV_BORDER_REPLICATE) return (j < 0) ? 0 : n - 1;
+    if (border != CONV_BORDER_REFLECT) return -1;
+    while (j < 0 || j >= n) {
+        if (j < 0) j = -j;
+        if (j >= n) j = 2 * n - 2 - j;
+    }
+    return j;
+}
+
+// Pixel (x, y) com a borda aplicada (-1 fora da imagem em zero e skip)
+static int check_pixel(const image_t* img, int x, int y, conv_border_t border) {
+    int ix = check_index(x, img->width, border);
+    int iy = check_index(y, img->height, border);
+
+    return (ix < 0 || iy < 0) ? -1 : image_row(img, iy)[ix];
+}
+
+// Saída do filtro em (x, y): magnitude do gradiente ou |Laplaciano|, saturados em 255.
+// No skip, 0 onde algum tap não nulo cai fora da imagem
+static uint8_t check_reference(const image_t* img, const check_filter_t* f, conv_border_t border, int x, int y) {
+    int origin = conv_window_origin(f->size_code);
+    int gx = 0, gy = 0, value, r, c;
+
+    for (r = 0; r < 5; r++) {
+        for (c = 0; c < 5; c++) {
+            int i = r * 5 + c;
+            int p = check_pixel(img, x + c - origin, y + r - origin, border);
+
+            if (p < 0) {
+                if (border == CONV_BORDER_SKIP && (f->gx[i] != 0 || (!f->laplaciano && f->gy[i] != 0))) return 0;
+                continue;
+            }
+            gx += p * f->gx[i];
+            gy += p * f->gy[i];
+        }
+    }
+    value = f->laplaciano ? abs(gx) : (int)sqrt((double)(gx * gx + gy * gy));
+    return (value > 255) ? 255 : (uint8_t)value;
+}
+
+/* ========== COMPARAÇÃO ========== */
+
+static void check_poison(image_t* img, int count) {
+    int i;
+
+    for (i = 0; i < count; i++) memset(img[i].data, CHECK_SENTINEL, (size_t)img[i].height * img[i].stride);
+}
+
+static void check_compare(const char* what, const check_filter_t* f, conv_border_t border,
+                          const image_t* expected, const image_t* got) {
+    int x, y;
+
+    check_cases++;
+    for (y = 0; y < expected->height; y++) {
+        const uint8_t* e = image_row(expected, y);
+        const uint8_t* g = image_row(got, y);
+        for (x = 0; x < expected->width; x++) {
+            if (e[x] != g[x]) {
+                printf("FALHA %s %s borda %s: (%d, %d) esperado %d, obtido %d\n",
+                       what, f->name, conv_border_name(border), x, y, e[x], g[x]);
+                check_failures++;
+                return;
+            }
+        }
+    }
+}
+
+/* ========== MODO EM FAIXAS ========== */
+
+typedef struct {
+    const image_t* src;
+    image_t* dst;
+    int next_row;
+} check_stream_t;
+
+static int check_stream_read(void* arg, uint8_t* dst, int dst_stride, int rows) {
+    check_stream_t* s = (check_stream_t*)arg;
+    int i;
+
+    for (i = 0; i < rows; i++) {
+        memcpy(dst + (size_t)i * dst_stride, image_row(s->src, s->next_row++), s->src->width);
+    }
+    return 0;
+}
+
+static int check_stream_write(void* arg, int index, const uint8_t* rows, int stride, int y0, int nrows) {
+    check_stream_t* s = (check_stream_t*)arg;
+    int i;
+
+    for (i = 0; i < nrows; i++) {
+        memcpy(image_row(&s->dst[index], y0 + i), rows + (size_t)i * stride, s->src->width);
+    }
+    return 0;
+}
+
+/* ========== EXECUÇÃO ========== */
+
+int main(void) {
+    const hw_backend_t* hw = hw_backend_sim();
+    thread_pool_t* pool = thread_pool_create(3);
+    conv_kernel_t kernels[CHECK_FILTERS];
+    uint8_t* planes[CHECK_FILTERS];
+    image_t src, expected[CHECK_FILTERS], got[CHECK_FILTERS];
+    check_stream_t stream;
+    int b, i, x, y;
+    int status = 1;
+
+    memset(expected, 0, sizeof(expected));
+    memset(got, 0, sizeof(got));
+    if (!pool || image_alloc(&src, CHECK_WIDTH, CHECK_HEIGHT, 1) != 0) {
+        fprintf(stderr, "Falta de memória\n");
+        return 1;
+    }
+    for (i = 0; i < CHECK_FILTERS; i++) {
+        if (image_alloc(&expected[i], CHECK_WIDTH, CHECK_HEIGHT, 1) != 0 ||
+            image_alloc(&got[i], CHECK_WIDTH, CHECK_HEIGHT, 1) != 0) {
+            fprintf(stderr, "Falta de memória\n");
+            goto done;
+        }
+        planes[i] = got[i].data;
+    }
+    check_image_fill(&src);
+    if (hw->init() != HW_SUCCESS) {
+        fprintf(stderr, "Falha ao iniciar o simulador\n");
+        goto done;
+    }
+
+    for (b = 0; b < CHECK_BORDERS; b++) {
+        conv_border_t border = check_borders[b];
+
+        for (i = 0; i < CHECK_FILTERS; i++) {
+            const check_filter_t* f = &check_filters[i];
+
+            for (y = 0; y < CHECK_HEIGHT; y++) {
+                for (x = 0; x < CHECK_WIDTH; x++) image_row(&expected[i], y)[x] = check_reference(&src, f, border, x, y);
+            }
+            conv_kernel_init(&kernels[i], f->gx, f->gy, f->size_code, f->laplaciano);
+            kernels[i].border = border;
+
+            check_poison(&got[i], 1);
+            if (conv_filter(&kernels[i], src.data, src.width, src.height, src.stride, got[i].data, got[i].stride) != 0) goto done;
+            check_compare("conv_filter", f, border, &expected[i], &got[i]);
+            check_poison(&got[i], 1);
+            if (conv_filter_bands(&kernels[i], src.data, src.width, src.height, src.stride, got[i].data, got[i].stride, NULL, 0) != 0) goto done;
+            check_compare("1 thread", f, border, &expected[i], &got[i]);
+            check_poison(&got[i], 1);
+            if (conv_filter_bands(&kernels[i], src.data, src.width, src.height, src.stride, got[i].data, got[i].stride, pool, 0) != 0) goto done;
+            check_compare("3 threads", f, border, &expected[i], &got[i]);
+            check_poison(&got[i], 1);
+            if (conv_filter_bands(&kernels[i], src.data, src.width, src.height, src.stride, got[i].data, got[i].stride, pool, 4) != 0) goto done;
+            check_compare("3 threads, faixas de 4", f, border, &expected[i], &got[i]);
+
+            check_poison(&got[i], 1);
+            if (fpga_filter_pass(hw, &src, f->gx, f->gy, f->size_code, f->laplaciano, border, &got[i]) != 0) {
+                fprintf(stderr, "Falha no simulador (%s)\n", f->name);
+                goto done;
+            }
+            check_compare("simulador", f, border, &expected[i], &got[i]);
+        }
+
+        check_poison(got, CHECK_FILTERS);
+        if (conv_filter_multi_bands(kernels, CHECK_FILTERS, src.data, src.width, src.height, src.stride, planes, got[0].stride, pool, 0) != 0) goto done;
+        for (i = 0; i < CHECK_FILTERS; i++) check_compare("passada única", &check_filters[i], border, &expected[i], &got[i]);
+
+        check_poison(got, CHECK_FILTERS);
+        stream.src = &src;
+        stream.dst = got;
+        stream.next_row = 0;
+        if (conv_filter_multi_stream(kernels, CHECK_FILTERS, src.width, src.height, check_stream_read, check_stream_write, &stream, pool, 8, 4) != 0) goto done;
+        for (i = 0; i < CHECK_FILTERS; i++) check_compare("em faixas", &check_filters[i], border, &expected[i], &got[i]);
+    }
+
+    printf("conv_check (%s): %d comparações, %d falhas\n", conv_simd_name(), check_cases, check_failures);
+    status = (check_failures == 0) ? 0 : 1;
+
+done:
+    hw->close();
+    for (i = 0; i < CHECK_FILTERS; i++) {
+        image_free(&expected[i]);
+        image_free(&got[i]);
+    }
+    image_free(&src);
+    thread_pool_destroy(pool);
+    return status;
+}
@@ -0,0 +1,832 @@
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <math.h>
+#include <pthread.h>
+#include "convolution.h"
+#include "convolution_simd.h"
+#include "image.h"
+
+/* ========== KERNEL ========== */
+
+int conv_window_origin(uint32_t size_code) {
+    // Roberts 2x2 ocupa o canto superior esquerdo da janela; os demais ficam centralizados
+    return (size_code == 0) ? 0 : 2;
+}
+
+static int conv_gcd(int a, int b) {
+    while (b != 0) {
+        int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Tenta escrever a máscara como produto externo v * h (posto 1).
+// h é a primeira linha não nula dividida pelo seu mdc, então v sempre sai inteiro.
+static int conv_factorize(const int* k, conv_factor_t* f) {
+    int h[CONV_TAPS], v[CONV_TAPS];
+    int pr = -1, pc = -1, g = 0;
+    int i, r, c;
+
+    for (i = 0; i < MATRIX_SIZE; i++) {
+        if (k[i] != 0) {
+            pr = i / CONV_TAPS;
+            pc = i % CONV_TAPS;
+            break;
+        }
+    }
+    if (pr < 0) return 0; // máscara nula fica no caminho direto
+
+    for (c = 0; c < CONV_TAPS; c++) {
+        g = conv_gcd(g, abs(k[pr * CONV_TAPS + c]));
+    }
+    if (k[pr * CONV_TAPS + pc] < 0) g = -g;
+    for (c = 0; c < CONV_TAPS; c++) {
+        h[c] = k[pr * CONV_TAPS + c] / g;
+    }
+
+    for (r = 0; r < CONV_TAPS; r++) {
+        if (k[r * CONV_TAPS + pc] % h[pc] != 0) return 0;
+        v[r] = k[r * CONV_TAPS + pc] / h[pc];
+        for (c = 0; c < CONV_TAPS; c++) {
+            if (v[r] * h[c] != k[r * CONV_TAPS + c]) return 0;
+        }
+    }
+
+    // Guarda só os fatores não nulos: 3x3 vira 3 + 3 operações, 5x5 vira 5 + 5
+    f->nh = 0;
+    f->nv = 0;
+    for (i = 0; i < CONV_TAPS; i++) {
+        if (h[i] != 0) {
+            f->h_off[f->nh] = i;
+            f->h_w[f->nh] = h[i];
+            f->nh++;
+        }
+        if (v[i] != 0) {
+            f->v_off[f->nv] = i;
+            f->v_w[f->nv] = v[i];
+            f->nv++;
+        }
+    }
+    return 1;
+}
+
+// Procura a máscara entre as geradas a partir de filters.c (comparando os taps)
+static conv_spec_fn conv_spec_lookup(const int* taps) {
+    int i;
+
+    for (i = 0; i < conv_spec_count; i++) {
+        if (memcmp(conv_spec_table[i].taps, taps, sizeof(int) * MATRIX_SIZE) == 0) {
+            return conv_spec_table[i].fn;
+        }
+    }
+    return NULL;
+}
+
+static void conv_mask_init(conv_mask_t* m, const int8_t* taps) {
+    int i;
+
+    m->ntaps = 0;
+    for (i = 0; i < MATRIX_SIZE; i++) {
+        m->taps[i] = taps[i];
+        if (taps[i] != 0) {
+            m->tap_r[m->ntaps] = i / CONV_TAPS;
+            m->tap_c[m->ntaps] = i % CONV_TAPS;
+            m->tap_w[m->ntaps] = taps[i];
+            m->ntaps++;
+        }
+    }
+    m->separable = conv_factorize(m->taps, &m->factor);
+    m->spec = conv_spec_lookup(m->taps);
+}
+
+void conv_kernel_init(conv_kernel_t* k, const int8_t* gx, const int8_t* gy, uint32_t size_code, int8_t laplaciano) {
+    int rmin = CONV_TAPS, rmax = -1, cmin = CONV_TAPS, cmax = -1;
+    int i;
+
+    conv_mask_init(&k->gx, gx);
+    conv_mask_init(&k->gy, gy);
+    k->origin = conv_window_origin(size_code);
+    k->laplaciano = laplaciano;
+    k->border = CONV_BORDER_ZERO;
+
+    // A região útil da janela é o retângulo dos taps não nulos (Gy é ignorado no Laplaciano)
+    for (i = 0; i < MATRIX_SIZE; i++) {
+        if (gx[i] != 0 || (!laplaciano && gy[i] != 0)) {
+            int r = i / CONV_TAPS, c = i % CONV_TAPS;
+            if (r < rmin) rmin = r;
+            if (r > rmax) rmax = r;
+            if (c < cmin) cmin = c;
+            if (c > cmax) cmax = c;
+        }
+    }
+    if (rmax < 0) {
+        rmin = rmax = k->origin;
+        cmin = cmax = k->origin;
+    }
+    k->margin_left = (k->origin > cmin) ? k->origin - cmin : 0;
+    k->margin_right = (cmax > k->origin) ? cmax - k->origin : 0;
+    k->margin_top = (k->origin > rmin) ? k->origin - rmin : 0;
+    k->margin_bottom = (rmax > k->origin) ? rmax - k->origin : 0;
+}
+
+static void conv_interior_span(int n, int before, int after, int* a, int* b) {
+    *a = (before < n) ? before : n;
+    *b = n - after;
+    if (*b < *a) *b = *a;
+}
+
+void conv_kernel_interior(const conv_kernel_t* k, int width, int height, int* x0, int* x1, int* y0, int* y1) {
+    conv_interior_span(width, k->margin_left, k->margin_right, x0, x1);
+    conv_interior_span(height, k->margin_top, k->margin_bottom, y0, y1);
+}
+
+int conv_border_parse(const char* name, conv_border_t* border) {
+    if (strcmp(name, "zero") == 0) *border = CONV_BORDER_ZERO;
+    else if (strcmp(name, "replicate") == 0) *border = CONV_BORDER_REPLICATE;
+    else if (strcmp(name, "reflect") == 0) *border = CONV_BORDER_REFLECT;
+    else if (strcmp(name, "skip") == 0) *border = CONV_BORDER_SKIP;
+    else return -1;
+    return 0;
+}
+
+const char* conv_border_name(conv_border_t border) {
+    switch (border) {
+        case CONV_BORDER_REPLICATE: return "replicate";
+        case CONV_BORDER_REFLECT:   return "reflect";
+        case CONV_BORDER_SKIP:      return "skip";
+        default:                    return "zero";
+    }
+}
+
+/* ========== BORDAS ========== */
+
+// Índice dentro de [0, n) que substitui j conforme a política de borda
+// (-1 quando o pixel deve valer zero)
+static int conv_border_index(int j, int n, conv_border_t border) {
+    if (j >= 0 && j < n) return j;
+
+    switch (border) {
+        case CONV_BORDER_REPLICATE:
+            return (j < 0) ? 0 : n - 1;
+        case CONV_BORDER_REFLECT:
+            if (n == 1) return 0;
+            while (j < 0 || j >= n) {
+                if (j < 0) j = -j;
+                if (j >= n) j = 2 * n - 2 - j;
+            }
+            return j;
+        default:
+            return -1;
+    }
+}
+
+// Copia as colunas [j0, j1) de uma linha, completando fora de [0, width) conforme a borda
+static void conv_pad_span(const uint8_t* row, int width, conv_border_t border, int j0, int j1, uint8_t* out) {
+    int j;
+
+    for (j = j0; j < j1; j++) {
+        int idx = (row != NULL) ? conv_border_index(j, width, border) : -1;
+        out[j - j0] = (idx >= 0) ? row[idx] : 0;
+    }
+}
+
+/* ========== ANEL DE LINHAS ========== */
+
+int conv_lines_init(conv_lines_t* l, const uint8_t* src, int width, int height, int stride, int origin,
+                    conv_border_t border) {
+    int i;
+
+    l->src = src;
+    l->width = width;
+    l->height = height;
+    l->stride = stride;
+    l->origin = origin;
+    l->border = border;
+    l->lines = calloc(CONV_TAPS, (size_t)(width + 2 * CONV_PAD));
+    if (!l->lines) return -1;
+
+    for (i = 0; i < CONV_TAPS; i++) {
+        l->line_row[i] = INT_MIN;
+        l->rows[i] = NULL;
+    }
+    return 0;
+}
+
+void conv_lines_seek(conv_lines_t* l, int y) {
+    int r;
+    int line_size = l->width + 2 * CONV_PAD;
+
+    for (r = 0; r < CONV_TAPS; r++) {
+        int sy = y + r - l->origin;
+        int slot = ((sy % CONV_TAPS) + CONV_TAPS) % CONV_TAPS;
+        uint8_t* line = l->lines + slot * line_size;
+
+        // Em uma varredura sequencial só a linha que entra no anel é carregada
+        if (l->line_row[slot] != sy) {
+            int src_y = conv_border_index(sy, l->height, l->border);
+            const uint8_t* src_row = (src_y >= 0) ? l->src + (size_t)src_y * l->stride : NULL;
+
+            if (src_row) {
+                memcpy(line + CONV_PAD, src_row, l->width);
+            } else {
+                memset(line + CONV_PAD, 0, l->width); // padding para bordas
+            }
+            conv_pad_span(src_row, l->width, l->border, -CONV_PAD, 0, line);
+            conv_pad_span(src_row, l->width, l->border, l->width, l->width + CONV_PAD, line + CONV_PAD + l->width);
+            l->line_row[slot] = sy;
+        }
+        l->slot[r] = slot;
+        l->rows[r] = line + CONV_PAD - l->origin;
+    }
+}
+
+void conv_lines_free(conv_lines_t* l) {
+    free(l->lines);
+    l->lines = NULL;
+}
+
+/* ========== CONVOLUÇÃO ========== */
+
+// Anel de passadas horizontais. Máscaras com o mesmo fator horizontal, a mesma
+// origem e a mesma borda (ex.: Gx do Sobel 3x3 e do Prewitt) dividem o mesmo anel.
+typedef struct {
+    const conv_factor_t* f;
+    int origin;
+    conv_border_t border;
+    int16_t* ring;                      // 5 linhas de passadas horizontais
+    int ring_row[CONV_TAPS];            // Linha virtual de cada passada guardada
+} conv_hring_t;
+
+// Estado de um kernel durante a aplicação do filtro. As linhas internas são lidas
+// direto da imagem de origem; só as colunas de borda passam por pequenos trechos completados.
+typedef struct {
+    const conv_kernel_t* k;
+    const conv_ops_t* ops;
+    const uint8_t* src;                 // Linha src_y0 da imagem (a origem pode ser só uma faixa)
+    int src_y0;
+    int width;
+    int height;
+    int stride;
+    int x0, x1;                         // Colunas internas [x0, x1)
+    int y0, y1;                         // Linhas internas [y0, y1)
+    uint8_t* zero_line;                 // Linha de zeros com margem (borda zero fora da imagem)
+    const uint8_t* src_rows[CONV_TAPS]; // Linhas da janela atual (coluna 0), já remapeadas pela borda
+    int src_key[CONV_TAPS];             // Linha virtual (y + r - origin) de cada uma
+    uint8_t* patch;                     // Trechos completados para as colunas de borda
+    const uint8_t* patch_rows[2][CONV_TAPS];
+    int patch_y;                        // Linha de saída dos trechos atuais
+    int16_t* acc[2];                    // Linha atual de Gx e Gy (int16, antes da magnitude)
+    conv_hring_t* hring[2];             // Anel de passadas de Gx e Gy (só máscaras separáveis)
+} conv_ctx_t;
+
+// Saturação para a faixa 0-255
+static inline uint8_t conv_saturate(int value) {
+    if (value < 0) return 0;
+    if (value > 255) return 255;
+    return (uint8_t)value;
+}
+
+// Caminho direto: só os taps não nulos são lidos, então a janela nunca
+// toca colunas ou linhas fora da região útil do kernel
+void conv_direct_row_c(const uint8_t* const* rows, const conv_mask_t* m, int16_t* out, int width) {
+    const uint8_t* p[MATRIX_SIZE];
+    int x, i;
+
+    // Máscaras de filters.c têm versão em linha reta; as demais usam a lista de taps
+    if (m->spec) {
+        m->spec(rows, out, width);
+        return;
+    }
+
+    for (i = 0; i < m->ntaps; i++) {
+        p[i] = rows[m->tap_r[i]] + m->tap_c[i];
+    }
+    for (x = 0; x < width; x++) {
+        int acc = 0;
+        for (i = 0; i < m->ntaps; i++) {
+            acc += p[i][x] * m->tap_w[i];
+        }
+        out[x] = (int16_t)acc;
+    }
+}
+
+// Passada horizontal de uma máscara separável sobre uma linha do anel
+void conv_hpass_row_c(const uint8_t* p, const conv_factor_t* f, int16_t* out, int width) {
+    int x, i;
+
+    for (x = 0; x < width; x++) {
+        int acc = 0;
+        for (i = 0; i < f->nh; i++) {
+            acc += p[x + f->h_off[i]] * f->h_w[i];
+        }
+        out[x] = (int16_t)acc;
+    }
+}
+
+// Passada vertical sobre as linhas intermediárias (só as de peso não nulo)
+void conv_vpass_row_c(const int16_t* const* h, const conv_factor_t* f, int16_t* out, int width) {
+    int x, i;
+
+    for (x = 0; x < width; x++) {
+        int acc = 0;
+        for (i = 0; i < f->nv; i++) {
+            acc += h[i][x] * f->v_w[i];
+        }
+        out[x] = (int16_t)acc;
+    }
+}
+
+void conv_gradient_row_c(const int16_t* gx, const int16_t* gy, uint8_t* out, int width) {
+    int x;
+
+    for (x = 0; x < width; x++) {
+        int sum = gx[x] * gx[x] + gy[x] * gy[x];
+        // Calcula a magnitude do gradiente
+        out[x] = conv_saturate((int)sqrt((double)sum));
+    }
+}
+
+// |Laplaciano| saturado em 255, como o out_pixel do ControlUnit
+void conv_laplacian_row_c(const int16_t* gx, uint8_t* out, int width) {
+    int x;
+
+    for (x = 0; x < width; x++) {
+        out[x] = conv_saturate(abs(gx[x]));
+    }
+}
+
+static const conv_ops_t conv_ops_c = {
+    "escalar",
+    conv_direct_row_c,
+    conv_hpass_row_c,
+    conv_vpass_row_c,
+    conv_gradient_row_c,
+    conv_laplacian_row_c
+};
+
+// Escolhe a melhor implementação suportada pela CPU. A variável de ambiente
+// CONV_SIMD (escalar, sse2, avx2 ou neon) força uma implementação específica.
+static const conv_ops_t* conv_select_ops(void) {
+    const conv_ops_t* candidates[4];
+    const char* force = getenv("CONV_SIMD");
+    int i, n = 0;
+
+    candidates[n++] = conv_ops_avx2();
+    candidates[n++] = conv_ops_sse2();
+    candidates[n++] = conv_ops_neon();
+    candidates[n++] = &conv_ops_c;
+
+    for (i = 0; i < n; i++) {
+        if (!candidates[i]) continue;
+        if (!force || strcmp(force, candidates[i]->name) == 0) return candidates[i];
+    }
+    return &conv_ops_c;
+}
+
+static const conv_ops_t* conv_selected_ops = NULL;
+static pthread_once_t conv_ops_once = PTHREAD_ONCE_INIT;
+
+static void conv_ops_init(void) {
+    conv_selected_ops = conv_select_ops();
+}
+
+static const conv_ops_t* conv_ops(void) {
+    // Escolha única e segura mesmo com várias faixas começando ao mesmo tempo
+    pthread_once(&conv_ops_once, conv_ops_init);
+    return conv_selected_ops;
+}
+
+const char* conv_simd_name(void) {
+    return conv_ops()->name;
+}
+
+// Aponta as 5 linhas da janela da saída y para a imagem (ou para a linha de zeros)
+static void conv_seek_rows(conv_ctx_t* ctx, int y) {
+    int r;
+
+    for (r = 0; r < CONV_TAPS; r++) {
+        int sy = y + r - ctx->k->origin;
+        int src_y = conv_border_index(sy, ctx->height, ctx->k->border);
+
+        ctx->src_rows[r] = (src_y >= 0) ? ctx->src + (size_t)(src_y - ctx->src_y0) * ctx->stride : ctx->zero_line;
+        ctx->src_key[r] = sy;
+    }
+}
+
+// Monta os trechos completados para as colunas de borda [0, x0) e [x1, width)
+static void conv_build_patches(conv_ctx_t* ctx, int y) {
+    int origin = ctx->k->origin;
+    int span = ctx->width + 2 * CONV_PAD;
+    int r;
+
+    if (ctx->patch_y == y) return;
+    for (r = 0; r < CONV_TAPS; r++) {
+        const uint8_t* row = (ctx->src_rows[r] == ctx->zero_line) ? NULL : ctx->src_rows[r];
+        uint8_t* left = ctx->patch + (size_t)(2 * r) * span;
+        uint8_t* right = left + span;
+
+        conv_pad_span(row, ctx->width, ctx->k->border, -origin, ctx->x0 - origin + CONV_TAPS - 1, left);
+        conv_pad_span(row, ctx->width, ctx->k->border, ctx->x1 - origin, ctx->width - origin + CONV_TAPS - 1, right);
+        ctx->patch_rows[0][r] = left;
+        ctx->patch_rows[1][r] = right;
+    }
+    ctx->patch_y = y;
+}
+
+static void conv_direct_mask_row(conv_ctx_t* ctx, const conv_mask_t* m, int16_t* out, int y) {
+    const uint8_t* rows[CONV_TAPS];
+    int r;
+
+    // Miolo: leitura direta da imagem, sem cópia e sem teste de borda por tap
+    if (ctx->x1 > ctx->x0) {
+        for (r = 0; r < CONV_TAPS; r++) {
+            rows[r] = ctx->src_rows[r] - ctx->k->origin + ctx->x0;
+        }
+        ctx->ops->direct_row(rows, m, out + ctx->x0, ctx->x1 - ctx->x0);
+    }
+
+    // Bordas: no máximo alguns pixels de cada lado
+    if (ctx->k->border == CONV_BORDER_SKIP) return;
+    if (ctx->x0 > 0 || ctx->x1 < ctx->width) {
+        conv_build_patches(ctx, y);
+        if (ctx->x0 > 0) conv_direct_row_c(ctx->patch_rows[0], m, out, ctx->x0);
+        if (ctx->x1 < ctx->width) conv_direct_row_c(ctx->patch_rows[1], m, out + ctx->x1, ctx->width - ctx->x1);
+    }
+}
+
+// Passada horizontal completa de uma linha (miolo direto da imagem, bordas completadas)
+static void conv_hpass_full(conv_ctx_t* ctx, const conv_factor_t* f, const uint8_t* row, int16_t* out) {
+    uint8_t edge[2 * CONV_PAD + CONV_TAPS];
+    int origin = ctx->k->origin;
+    int x0 = ctx->x0, x1 = ctx->x1;
+
+    if (x1 > x0) ctx->ops->hpass_row(row - origin + x0, f, out + x0, x1 - x0);
+    if (x0 > 0) {
+        conv_pad_span(row, ctx->width, ctx->k->border, -origin, x0 - origin + CONV_TAPS - 1, edge);
+        conv_hpass_row_c(edge, f, out, x0);
+    }
+    if (x1 < ctx->width) {
+        conv_pad_span(row, ctx->width, ctx->k->border, x1 - origin, ctx->width - origin + CONV_TAPS - 1, edge);
+        conv_hpass_row_c(edge, f, out + x1, ctx->width - x1);
+    }
+}
+
+// No motor escalar a versão gerada (que o compilador ainda vetoriza) ganha das duas
+// passadas; com SIMD as passadas separáveis continuam mais rápidas
+static int conv_mask_direct(const conv_ctx_t* ctx, const conv_mask_t* m) {
+    return !m->separable || (m->spec && ctx->ops == &conv_ops_c);
+}
+
+static void conv_mask_row(conv_ctx_t* ctx, const conv_mask_t* m, int plane, int y) {
+    const conv_factor_t* f = &m->factor;
+    conv_hring_t* hring = ctx->hring[plane];
+    const int16_t* h[CONV_TAPS];
+    int i;
+
+    if (conv_mask_direct(ctx, m)) {
+        conv_direct_mask_row(ctx, m, ctx->acc[plane], y);
+        return;
+    }
+
+    // Cada linha da imagem passa uma única vez pela passada horizontal
+    for (i = 0; i < f->nv; i++) {
+        int r = f->v_off[i];
+        int sy = ctx->src_key[r];
+        int slot = ((sy % CONV_TAPS) + CONV_TAPS) % CONV_TAPS;
+        int16_t* hr = hring->ring + (size_t)slot * ctx->width;
+
+        if (hring->ring_row[slot] != sy) {
+            const uint8_t* row = (ctx->src_rows[r] == ctx->zero_line) ? NULL : ctx->src_rows[r];
+
+            if (row) {
+                conv_hpass_full(ctx, f, row, hr);
+            } else {
+                memset(hr, 0, sizeof(int16_t) * (size_t)ctx->width);
+            }
+            hring->ring_row[slot] = sy;
+        }
+        h[i] = hr;
+    }
+    ctx->ops->vpass_row(h, f, ctx->acc[plane], ctx->width);
+}
+
+// Calcula a linha y de um kernel
+static void conv_ctx_row(conv_ctx_t* ctx, uint8_t* out, int y) {
+    const conv_kernel_t* k = ctx->k;
+    int width = ctx->width;
+
+    if (k->border == CONV_BORDER_SKIP && (y < ctx->y0 || y >= ctx->y1)) {
+        memset(out, 0, (size_t)width);
+        return;
+    }
+
+    conv_seek_rows(ctx, y);
+    conv_mask_row(ctx, &k->gx, 0, y);
+
+    if (k->laplaciano) {
+        ctx->ops->laplacian_row(ctx->acc[0], out, width);
+    } else {
+        conv_mask_row(ctx, &k->gy, 1, y);
+        ctx->ops->gradient_row(ctx->acc[0], ctx->acc[1], out, width);
+    }
+
+    if (k->border == CONV_BORDER_SKIP) {
+        memset(out, 0, (size_t)ctx->x0);
+        memset(out + ctx->x1, 0, (size_t)(width - ctx->x1));
+    }
+}
+
+static int conv_same_hpass(const conv_hring_t* hr, const conv_ctx_t* ctx, const conv_factor_t* f) {
+    int i;
+
+    if (hr->origin != ctx->k->origin || hr->border != ctx->k->border || hr->f->nh != f->nh) return 0;
+    for (i = 0; i < f->nh; i++) {
+        if (hr->f->h_off[i] != f->h_off[i] || hr->f->h_w[i] != f->h_w[i]) return 0;
+    }
+    return 1;
+}
+
+// Devolve o anel de passadas horizontais da máscara, criando um novo só se
+// nenhum kernel anterior usar a mesma passada
+static conv_hring_t* conv_hring_get(conv_hring_t* hrings, int* count, const conv_ctx_t* ctx, const conv_mask_t* m) {
+    conv_hring_t* hr;
+    int i;
+
+    if (conv_mask_direct(ctx, m)) return NULL;
+    for (i = 0; i < *count; i++) {
+        if (conv_same_hpass(&hrings[i], ctx, &m->factor)) return &hrings[i];
+    }
+
+    hr = &hrings[(*count)++];
+    hr->f = &m->factor;
+    hr->origin = ctx->k->origin;
+    hr->border = ctx->k->border;
+    hr->ring = malloc(sizeof(int16_t) * (size_t)ctx->width * CONV_TAPS);
+    for (i = 0; i < CONV_TAPS; i++) hr->ring_row[i] = INT_MIN;
+    return hr;
+}
+
+// src aponta para a linha src_y0 da imagem e dst[i] para a linha dst_y0 da saída,
+// para que a origem e os planos de saída possam ser só uma faixa em memória
+static int conv_filter_multi_core(const conv_kernel_t* k, int count, const uint8_t* src, int src_y0,
+                                  int width, int height, int src_stride, uint8_t* const* dst, int dst_y0,
+                                  int dst_stride, int y0, int y1) {
+    conv_ctx_t* ctx;
+    conv_hring_t* hrings;
+    uint8_t* zero_line;
+    int span = width + 2 * CONV_PAD;
+    int nhrings = 0;
+    int status = 0;
+    int y, i;
+
+    // O estado fica todo na pilha/heap desta chamada: faixas diferentes não compartilham nada
+    ctx = calloc((size_t)count, sizeof(conv_ctx_t));
+    hrings = calloc((size_t)(2 * count), sizeof(conv_hring_t));
+    zero_line = calloc(1, (size_t)span);
+    if (!ctx || !hrings || !zero_line) {
+        status = -1;
+        goto done;
+    }
+
+    for (i = 0; i < count; i++) {
+        conv_ctx_t* c = &ctx[i];
+
+        c->k = &k[i];
+        c->ops = conv_ops();
+        c->src = src;
+        c->src_y0 = src_y0;
+        c->width = width;
+        c->height = height;
+        c->stride = src_stride;
+        conv_kernel_interior(c->k, width, height, &c->x0, &c->x1, &c->y0, &c->y1);
+        c->zero_line = zero_line + CONV_PAD;
+        c->patch_y = INT_MIN;
+
+        // 2 linhas de acumulação por kernel; os anéis de 5 linhas são compartilhados
+        c->acc[0] = malloc(sizeof(int16_t) * (size_t)width * 2);
+        c->patch = malloc((size_t)(2 * CONV_TAPS) * span);
+        if (!c->acc[0] || !c->patch) {
+            status = -1;
+            goto done;
+        }
+        c->acc[1] = c->acc[0] + width;
+        c->hring[0] = conv_hring_get(hrings, &nhrings, c, &c->k->gx);
+        c->hring[1] = c->k->laplaciano ? NULL : conv_hring_get(hrings, &nhrings, c, &c->k->gy);
+        if ((c->hring[0] && !c->hring[0]->ring) || (c->hring[1] && !c->hring[1]->ring)) {
+            status = -1;
+            goto done;
+        }
+    }
+
+    // Todos os kernels consomem a linha y antes de avançar, então a janela de
+    // linhas da origem é lida uma vez e reaproveitada ainda quente na cache.
+    // As linhas de halo acima e abaixo da faixa são lidas direto da imagem de origem.
+    for (y = y0; y < y1; y++) {
+        for (i = 0; i < count; i++) {
+            conv_ctx_row(&ctx[i], dst[i] + (size_t)(y - dst_y0) * dst_stride, y);
+        }
+    }
+
+done:
+    if (ctx) {
+        for (i = 0; i < count; i++) {
+            free(ctx[i].acc[0]);
+            free(ctx[i].patch);
+        }
+    }
+    if (hrings) {
+        for (i = 0; i < nhrings; i++) free(hrings[i].ring);
+    }
+    free(ctx);
+    free(hrings);
+    free(zero_line);
+    return status;
+}
+
+int conv_filter_multi_rows(const conv_kernel_t* k, int count, const uint8_t* src, int width, int height,
+                           int src_stride, uint8_t* const* dst, int dst_stride, int y0, int y1) {
+    return conv_filter_multi_core(k, count, src, 0, width, height, src_stride, dst, 0, dst_stride, y0, y1);
+}
+
+int conv_filter_rows(const conv_kernel_t* k, const uint8_t* src, int width, int height, int src_stride,
+                     uint8_t* dst, int dst_stride, int y0, int y1) {
+    return conv_filter_multi_rows(k, 1, src, width, height, src_stride, &dst, dst_stride, y0, y1);
+}
+
+int conv_filter(const conv_kernel_t* k, const uint8_t* src, int width, int height, int src_stride,
+                uint8_t* dst, int dst_stride) {
+    return conv_filter_rows(k, src, width, height, src_stride, dst, dst_stride, 0, height);
+}
+
+/* ========== EXECUÇÃO EM FAIXAS ========== */
+
+typedef struct {
+    const conv_kernel_t* k;
+    int count;
+    const uint8_t* src;
+    int src_y0;
+    int width;
+    int height;
+    int src_stride;
+    uint8_t* const* dst;
+    int dst_y0;
+    int dst_stride;
+    int y_begin, y_end;                 // Linhas de saída divididas entre as faixas
+    int band_height;
+    int status;
+} conv_band_job_t;
+
+static void conv_band_task(void* arg, int index) {
+    conv_band_job_t* job = arg;
+    int y0 = job->y_begin + index * job->band_height;
+    int y1 = y0 + job->band_height;
+
+    if (y1 > job->y_end) y1 = job->y_end;
+    if (conv_filter_multi_core(job->k, job->count, job->src, job->src_y0, job->width, job->height,
+                               job->src_stride, job->dst, job->dst_y0, job->dst_stride, y0, y1) != 0) {
+        __atomic_store_n(&job->status, -1, __ATOMIC_RELAXED);
+    }
+}
+
+// Divide as saídas [y_begin, y_end) em faixas no pool
+static int conv_run_bands(conv_band_job_t* job, thread_pool_t* pool) {
+    int rows = job->y_end - job->y_begin;
+
+    job->status = 0;
+    thread_pool_run(pool, conv_band_task, job, (rows + job->band_height - 1) / job->band_height);
+    return job->status;
+}
+
+int conv_band_height_auto(int height, int threads) {
+    // ~4 faixas por thread equilibram a carga; faixas muito baixas gastam demais com o halo
+    int bands = threads * 4;
+    int band_height = (height + bands - 1) / bands;
+
+    return band_height < CONV_MIN_BAND ? CONV_MIN_BAND : band_height;
+}
+
+int conv_filter_multi_bands(const conv_kernel_t* k, int count, const uint8_t* src, int width, int height,
+                            int src_stride, uint8_t* const* dst, int dst_stride, thread_pool_t* pool,
+                            int band_height) {
+    conv_band_job_t job;
+
+    if (height <= 0 || count <= 0) return 0;
+    if (band_height <= 0) band_height = conv_band_height_auto(height, thread_pool_size(pool));
+
+    job.k = k;
+    job.count = count;
+    job.src = src;
+    job.src_y0 = 0;
+    job.width = width;
+    job.height = height;
+    job.src_stride = src_stride;
+    job.dst = dst;
+    job.dst_y0 = 0;
+    job.dst_stride = dst_stride;
+    job.y_begin = 0;
+    job.y_end = height;
+    job.band_height = band_height;
+    return conv_run_bands(&job, pool);
+}
+
+int conv_filter_bands(const conv_kernel_t* k, const uint8_t* src, int width, int height, int src_stride,
+                      uint8_t* dst, int dst_stride, thread_pool_t* pool, int band_height) {
+    return conv_filter_multi_bands(k, 1, src, width, height, src_stride, &dst, dst_stride, pool, band_height);
+}
+
+/* ========== PROCESSAMENTO EM FAIXAS DE UM ARQUIVO ========== */
+
+int conv_stream_strip_auto(int threads) {
+    int strip = CONV_MIN_BAND * 4 * threads;
+
+    return strip < CONV_STREAM_STRIP ? CONV_STREAM_STRIP : strip;
+}
+
+// A faixa de entrada guarda as linhas [b0, b0 + rows): as de saída [s0, s1) mais
+// CONV_PAD de halo de cada lado, que cobre as duas origens (0 e 2) e as bordas
+// espelhadas. Ao avançar, só o halo de baixo é movido para o início.
+int conv_filter_multi_stream(const conv_kernel_t* k, int count, int width, int height,
+                             conv_read_fn read_rows, conv_write_fn write_rows, void* arg,
+                             thread_pool_t* pool, int strip_height, int band_height) {
+    conv_band_job_t job;
+    uint8_t* in = NULL;
+    uint8_t** out = NULL;
+    size_t in_stride, out_stride;
+    int in_cap, b0 = 0, rows = 0, s0, s1, i;
+    int status = -1;
+
+    if (height <= 0 || count <= 0) return 0;
+    if (strip_height <= 0) strip_height = conv_stream_strip_auto(thread_pool_size(pool));
+    if (band_height <= 0 || band_height > strip_height) {
+        band_height = conv_band_height_auto(strip_height, thread_pool_size(pool));
+    }
+
+    // Linhas alinhadas como em image_alloc, para as cargas vetoriais
+    in_stride = ((size_t)width + IMAGE_ALIGN - 1) & ~(size_t)(IMAGE_ALIGN - 1);
+    out_stride = in_stride;
+    in_cap = strip_height + 2 * CONV_PAD;
+    out = calloc((size_t)count, sizeof(uint8_t*));
+    if (!out || posix_memalign((void**)&in, IMAGE_ALIGN, in_stride * in_cap) != 0) {
+        in = NULL;
+        goto done;
+    }
+    for (i = 0; i < count; i++) {
+        if (posix_memalign((void**)&out[i], IMAGE_ALIGN, out_stride * strip_height) != 0) {
+            out[i] = NULL;
+            goto done;
+        }
+    }
+
+    job.k = k;
+    job.count = count;
+    job.src = in;
+    job.width = width;
+    job.height = height;
+    job.src_stride = (int)in_stride;
+    job.dst = out;
+    job.dst_stride = (int)out_stride;
+    job.band_height = band_height;
+
+    for (s0 = 0; s0 < height; s0 = s1) {
+        int need;
+
+        s1 = s0 + strip_height < height ? s0 + strip_height : height;
+        need = s1 + CONV_PAD < height ? s1 + CONV_PAD : height;
+
+        // Descarta as linhas que nenhuma saída a partir de s0 ainda usa
+        if (s0 - CONV_PAD > b0) {
+            int drop = s0 - CONV_PAD - b0;
+
+            memmove(in, in + (size_t)drop * in_stride, (size_t)(rows - drop) * in_stride);
+            b0 += drop;
+            rows -= drop;
+        }
+        if (b0 + rows < need) {
+            if (read_rows(arg, in + (size_t)rows * in_stride, (int)in_stride, need - b0 - rows) != 0) goto done;
+            rows = need - b0;
+        }
+
+        job.src_y0 = b0;
+        job.dst_y0 = s0;
+        job.y_begin = s0;
+        job.y_end = s1;
+        if (conv_run_bands(&job, pool) != 0) goto done;
+
+        // As linhas [s0, s1) já são finais: saem antes de a próxima faixa ser lida
+        for (i = 0; i < count; i++) {
+            if (write_rows(arg, i, out[i], (int)out_stride, s0, s1 - s0) != 0) goto done;
+        }
+    }
+    status = 0;
+
+done:
+    if (out) {
+        for (i = 0; i < count; i++) free(out[i]);
+    }
+    free(out);
+    free(in);
+    return status;
+}
@@ -0,0 +1,143 @@
+#ifndef CONVOLUTION_H
+#define CONVOLUTION_H
+#include <stdint.h>
+#include "interface.h"
+#include "thread_pool.h"
+
+/* ========== CONSTANTES DO MOTOR DE CONVOLUÇÃO ========== */
+#define CONV_TAPS   5       // Janela sempre 5x5 (mesmo layout de filters.c)
+#define CONV_PAD    4       // Margem em cada lado das linhas do anel
+#define CONV_MIN_BAND 16    // Altura mínima de faixa na divisão automática
+#define CONV_STREAM_STRIP 64 // Altura mínima da faixa lida por vez no modo de arquivo em faixas
+
+/* ========== ESTRUTURAS DE DADOS ========== */
+
+// Tratamento dos pixels cuja janela sai da imagem
+typedef enum {
+    CONV_BORDER_ZERO = 0,   // Completa com zeros (comportamento original)
+    CONV_BORDER_REPLICATE,  // Repete o pixel da borda: a a | a b c
+    CONV_BORDER_REFLECT,    // Espelha sem repetir a borda: c b | a b c
+    CONV_BORDER_SKIP        // Não calcula a borda: esses pixels saem 0
+} conv_border_t;
+
+// Fatoração de um kernel separável, k[r][c] = v[r] * h[c], guardando só os fatores não nulos
+typedef struct {
+    int nh;
+    int h_off[CONV_TAPS];
+    int h_w[CONV_TAPS];
+    int nv;
+    int v_off[CONV_TAPS];
+    int v_w[CONV_TAPS];
+} conv_factor_t;
+
+// Linha de convolução direta gerada para uma máscara de filters.c (convolution_spec.c)
+typedef void (*conv_spec_fn)(const uint8_t* const* rows, int16_t* out, int width);
+
+// Uma máscara 5x5 (Gx ou Gy), a lista dos seus taps não nulos e, quando existir, sua fatoração
+typedef struct {
+    int taps[MATRIX_SIZE];
+    int ntaps;
+    int tap_r[MATRIX_SIZE];
+    int tap_c[MATRIX_SIZE];
+    int tap_w[MATRIX_SIZE];
+    int separable;          // 1 = passada horizontal + passada vertical
+    conv_factor_t factor;
+    conv_spec_fn spec;      // Versão especializada (NULL para máscaras desconhecidas)
+} conv_mask_t;
+
+// Kernel preparado para o motor (taps no layout 5x5 de filters.c)
+typedef struct {
+    conv_mask_t gx;
+    conv_mask_t gy;
+    int origin;             // Deslocamento da janela: 0 para Roberts 2x2, 2 para 3x3/5x5
+    int laplaciano;         // 1 = usa apenas Gx e satura |Gx| em 255
+    conv_border_t border;   // CONV_BORDER_ZERO por padrão
+    // Quantos pixels de cada lado têm a janela (taps não nulos) saindo da imagem
+    int margin_left;
+    int margin_right;
+    int margin_top;
+    int margin_bottom;
+} conv_kernel_t;
+
+// Anel de 5 linhas com margem (usado para montar as janelas enviadas à FPGA):
+// cada linha da imagem é copiada uma única vez e reaproveitada pelas 5 linhas
+// de saída que a utilizam
+typedef struct {
+    const uint8_t* src;
+    int width;
+    int height;
+    int stride;
+    int origin;
+    conv_border_t border;
+    uint8_t* lines;                     // 5 linhas de (width + 2 * CONV_PAD) bytes
+    int line_row[CONV_TAPS];            // Linha da imagem guardada em cada posição do anel
+    int slot[CONV_TAPS];                // Posição do anel usada por cada linha da janela atual
+    const uint8_t* rows[CONV_TAPS];     // Linhas da janela atual, já deslocadas pela origem
+} conv_lines_t;
+
+/* ========== DECLARAÇÕES DE FUNÇÕES ========== */
+
+// Deslocamento da janela para o size_code usado pela FPGA
+int conv_window_origin(uint32_t size_code);
+
+// Prepara um kernel a partir das tabelas de filters.c, detectando máscaras separáveis
+void conv_kernel_init(conv_kernel_t* k, const int8_t* gx, const int8_t* gy, uint32_t size_code, int8_t laplaciano);
+
+// Região [x0, x1) x [y0, y1) de saídas cuja janela cabe inteira na imagem
+void conv_kernel_interior(const conv_kernel_t* k, int width, int height, int* x0, int* x1, int* y0, int* y1);
+
+// Converte "zero", "replicate", "reflect" ou "skip" (retorna -1 se inválido)
+int conv_border_parse(const char* name, conv_border_t* border);
+const char* conv_border_name(conv_border_t border);
+
+// Anel de linhas: após conv_lines_seek(l, y), rows[r][x + c] é o pixel
+// (y + r - origin, x + c - origin), completado fora da imagem conforme border
+// (CONV_BORDER_SKIP completa com zeros; quem chama decide não usar esses pixels)
+int conv_lines_init(conv_lines_t* l, const uint8_t* src, int width, int height, int stride, int origin,
+                    conv_border_t border);
+void conv_lines_seek(conv_lines_t* l, int y);
+void conv_lines_free(conv_lines_t* l);
+
+// Nome da implementação vetorial em uso (escalar, sse2, avx2 ou neon)
+const char* conv_simd_name(void);
+
+// Aplica o kernel na imagem inteira (0 = sucesso, -1 = falta de memória).
+// Reentrante: todo o estado fica na chamada, src é só lido.
+int conv_filter(const conv_kernel_t* k, const uint8_t* src, int width, int height, int src_stride,
+                uint8_t* dst, int dst_stride);
+
+// Mesmo que conv_filter, mas só escreve as linhas de saída [y0, y1)
+int conv_filter_rows(const conv_kernel_t* k, const uint8_t* src, int width, int height, int src_stride,
+                     uint8_t* dst, int dst_stride, int y0, int y1);
+
+// Divide a saída em faixas de band_height linhas e processa no pool
+// (band_height <= 0 escolhe automaticamente; pool NULL roda na thread atual)
+int conv_band_height_auto(int height, int threads);
+int conv_filter_bands(const conv_kernel_t* k, const uint8_t* src, int width, int height, int src_stride,
+                      uint8_t* dst, int dst_stride, thread_pool_t* pool, int band_height);
+
+// Vários kernels numa única varredura: k[i] escreve no plano dst[i]. Cada linha da
+// origem é lida uma vez para todos, e máscaras com a mesma passada horizontal
+// (mesmo fator, origem e borda) calculam essa passada uma única vez.
+int conv_filter_multi_rows(const conv_kernel_t* k, int count, const uint8_t* src, int width, int height,
+                           int src_stride, uint8_t* const* dst, int dst_stride, int y0, int y1);
+int conv_filter_multi_bands(const conv_kernel_t* k, int count, const uint8_t* src, int width, int height,
+                            int src_stride, uint8_t* const* dst, int dst_stride, thread_pool_t* pool,
+                            int band_height);
+
+// Modo em faixas para imagens maiores que a memória: a origem chega em blocos de
+// linhas por read e cada plano de saída sai em blocos por write assim que fica pronto.
+// Em memória ficam só strip_height linhas de saída por kernel e a faixa de entrada
+// com o halo (strip_height + 2 * CONV_PAD linhas). Cada faixa é dividida no pool
+// em sub-faixas de band_height linhas (<= 0 escolhe automaticamente).
+//   read_rows(arg, dst, stride, rows): próximas 'rows' linhas da origem (0 = sucesso)
+//   write_rows(arg, i, rows, stride, y0, n): linhas [y0, y0 + n) do kernel i (0 = sucesso)
+typedef int (*conv_read_fn)(void* arg, uint8_t* dst, int dst_stride, int rows);
+typedef int (*conv_write_fn)(void* arg, int index, const uint8_t* rows, int stride, int y0, int nrows);
+
+int conv_stream_strip_auto(int threads);
+int conv_filter_multi_stream(const conv_kernel_t* k, int count, int width, int height,
+                             conv_read_fn read_rows, conv_write_fn write_rows, void* arg,
+                             thread_pool_t* pool, int strip_height, int band_height);
+
+#endif
@@ -0,0 +1,133 @@
+#include <stddef.h>
+#include "convolution_simd.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#if defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/* ========== NEON: 8 PIXELS POR ITERAÇÃO ========== */
+
+static inline int16x8_t conv_load8_neon(const uint8_t* p) {
+    return vreinterpretq_s16_u16(vmovl_u8(vld1_u8(p)));
+}
+
+static void conv_direct_row_neon(const uint8_t* const* rows, const conv_mask_t* m, int16_t* out, int width) {
+    const uint8_t* shifted[CONV_TAPS];
+    int x, i;
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        int16x8_t acc = vdupq_n_s16(0);
+        for (i = 0; i < m->ntaps; i++) {
+            int16x8_t p = conv_load8_neon(rows[m->tap_r[i]] + x + m->tap_c[i]);
+            acc = vqaddq_s16(acc, vmulq_n_s16(p, (int16_t)m->tap_w[i]));
+        }
+        vst1q_s16(out + x, acc);
+    }
+    if (x < width) {
+        for (i = 0; i < CONV_TAPS; i++) shifted[i] = rows[i] + x;
+        conv_direct_row_c(shifted, m, out + x, width - x);
+    }
+}
+
+static void conv_hpass_row_neon(const uint8_t* p, const conv_factor_t* f, int16_t* out, int width) {
+    int x, i;
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        int16x8_t acc = vdupq_n_s16(0);
+        for (i = 0; i < f->nh; i++) {
+            int16x8_t v = conv_load8_neon(p + x + f->h_off[i]);
+            acc = vqaddq_s16(acc, vmulq_n_s16(v, (int16_t)f->h_w[i]));
+        }
+        vst1q_s16(out + x, acc);
+    }
+    if (x < width) conv_hpass_row_c(p + x, f, out + x, width - x);
+}
+
+static void conv_vpass_row_neon(const int16_t* const* h, const conv_factor_t* f, int16_t* out, int width) {
+    const int16_t* shifted[CONV_TAPS];
+    int x, i;
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        int16x8_t acc = vdupq_n_s16(0);
+        for (i = 0; i < f->nv; i++) {
+            int16x8_t v = vld1q_s16(h[i] + x);
+            acc = vqaddq_s16(acc, vmulq_n_s16(v, (int16_t)f->v_w[i]));
+        }
+        vst1q_s16(out + x, acc);
+    }
+    if (x < width) {
+        for (i = 0; i < f->nv; i++) shifted[i] = h[i] + x;
+        conv_vpass_row_c(shifted, f, out + x, width - x);
+    }
+}
+
+// floor(sqrt(n)) exato para n em [0, 65535]. O ARMv7 não tem vsqrtq_f32, então a
+// estimativa vem de vrsqrteq com dois passos de Newton e é corrigida em inteiro.
+static inline int32x4_t conv_isqrt_neon(int32x4_t n) {
+    int32x4_t m = vminq_s32(n, vdupq_n_s32(65535));
+    float32x4_t f = vcvtq_f32_s32(vmaxq_s32(m, vdupq_n_s32(1)));
+    float32x4_t r = vrsqrteq_f32(f);
+    int32x4_t s, s1;
+
+    r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(f, r), r));
+    r = vmulq_f32(r, vrsqrtsq_f32(vmulq_f32(f, r), r));
+    s = vcvtq_s32_f32(vmulq_f32(f, r));
+
+    // (s + 1)² <= m: soma 1; s² > m: subtrai 1 (a máscara de comparação vale -1)
+    s1 = vaddq_s32(s, vdupq_n_s32(1));
+    s = vsubq_s32(s, vreinterpretq_s32_u32(vcleq_s32(vmulq_s32(s1, s1), m)));
+    s = vaddq_s32(s, vreinterpretq_s32_u32(vcgtq_s32(vmulq_s32(s, s), m)));
+    return s;
+}
+
+static void conv_gradient_row_neon(const int16_t* gx, const int16_t* gy, uint8_t* out, int width) {
+    int x;
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        int16x8_t vx = vld1q_s16(gx + x);
+        int16x8_t vy = vld1q_s16(gy + x);
+        int32x4_t lo = vmlal_s16(vmull_s16(vget_low_s16(vx), vget_low_s16(vx)), vget_low_s16(vy), vget_low_s16(vy));
+        int32x4_t hi = vmlal_s16(vmull_s16(vget_high_s16(vx), vget_high_s16(vx)), vget_high_s16(vy), vget_high_s16(vy));
+        int16x8_t m16 = vcombine_s16(vqmovn_s32(conv_isqrt_neon(lo)), vqmovn_s32(conv_isqrt_neon(hi)));
+        vst1_u8(out + x, vqmovun_s16(m16));
+    }
+    if (x < width) conv_gradient_row_c(gx + x, gy + x, out + x, width - x);
+}
+
+static void conv_laplacian_row_neon(const int16_t* gx, uint8_t* out, int width) {
+    int x;
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        // vqabs leva -32768 a 32767 e vqmovun satura em 255
+        vst1_u8(out + x, vqmovun_s16(vqabsq_s16(vld1q_s16(gx + x))));
+    }
+    if (x < width) conv_laplacian_row_c(gx + x, out + x, width - x);
+}
+
+static const conv_ops_t conv_ops_neon_table = {
+    "neon",
+    conv_direct_row_neon,
+    conv_hpass_row_neon,
+    conv_vpass_row_neon,
+    conv_gradient_row_neon,
+    conv_laplacian_row_neon
+};
+
+const conv_ops_t* conv_ops_neon(void) {
+#if defined(__arm__)
+    // No ARMv7 o NEON é opcional; o Cortex-A9 do DE1-SoC tem
+    if (!(getauxval(AT_HWCAP) & HWCAP_NEON)) return NULL;
+#endif
+    return &conv_ops_neon_table;
+}
+
+#else
+
+const conv_ops_t* conv_ops_neon(void) {
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef CONVOLUTION_SIMD_H
+#define CONVOLUTION_SIMD_H
+#include <stdint.h>
+#include "convolution.h"
+
+/* ========== TABELA DE ROTINAS POR CONJUNTO DE INSTRUÇÕES ========== */
+
+// Todas as implementações usam aritmética inteira exata em int16, então a
+// saída é idêntica bit a bit à das rotinas escalares de referência
+typedef struct {
+    const char* name;
+    void (*direct_row)(const uint8_t* const* rows, const conv_mask_t* m, int16_t* out, int width);
+    void (*hpass_row)(const uint8_t* p, const conv_factor_t* f, int16_t* out, int width);
+    void (*vpass_row)(const int16_t* const* h, const conv_factor_t* f, int16_t* out, int width);
+    void (*gradient_row)(const int16_t* gx, const int16_t* gy, uint8_t* out, int width);
+    void (*laplacian_row)(const int16_t* gx, uint8_t* out, int width);
+} conv_ops_t;
+
+/* ========== ROTINAS ESCALARES (REFERÊNCIA E SOBRAS DE FIM DE LINHA) ========== */
+void conv_direct_row_c(const uint8_t* const* rows, const conv_mask_t* m, int16_t* out, int width);
+void conv_hpass_row_c(const uint8_t* p, const conv_factor_t* f, int16_t* out, int width);
+void conv_vpass_row_c(const int16_t* const* h, const conv_factor_t* f, int16_t* out, int width);
+void conv_gradient_row_c(const int16_t* gx, const int16_t* gy, uint8_t* out, int width);
+void conv_laplacian_row_c(const int16_t* gx, uint8_t* out, int width);
+
+/* ========== MÁSCARAS ESPECIALIZADAS (GERADAS POR gen_kernels) ========== */
+
+// Tabela de convolution_spec.c: os 25 taps de cada máscara de filters.c e a
+// função em linha reta correspondente
+typedef struct {
+    int taps[MATRIX_SIZE];
+    conv_spec_fn fn;
+} conv_spec_t;
+
+extern const conv_spec_t conv_spec_table[];
+extern const int conv_spec_count;
+
+/* ========== IMPLEMENTAÇÕES VETORIAIS ========== */
+
+// Retornam NULL quando não foram compiladas ou a CPU não suporta as instruções
+const conv_ops_t* conv_ops_avx2(void);
+const conv_ops_t* conv_ops_sse2(void);
+const conv_ops_t* conv_ops_neon(void);
+
+#endif
@@ -0,0 +1,256 @@
+#include <stddef.h>
+#include "convolution_simd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+// Cada função leva o atributo target do seu conjunto de instruções, então o
+// arquivo compila sem flags extras e a escolha fica para conv_select_ops()
+#define CONV_SSE2 __attribute__((target("sse2")))
+#define CONV_AVX2 __attribute__((target("avx2")))
+
+// Termina a linha com as rotinas escalares a partir da coluna x
+static void conv_direct_tail(const uint8_t* const* rows, const conv_mask_t* m, int16_t* out, int x, int width) {
+    const uint8_t* shifted[CONV_TAPS];
+    int r;
+
+    for (r = 0; r < CONV_TAPS; r++) shifted[r] = rows[r] + x;
+    conv_direct_row_c(shifted, m, out + x, width - x);
+}
+
+static void conv_vpass_tail(const int16_t* const* h, const conv_factor_t* f, int16_t* out, int x, int width) {
+    const int16_t* shifted[CONV_TAPS];
+    int i;
+
+    for (i = 0; i < f->nv; i++) shifted[i] = h[i] + x;
+    conv_vpass_row_c(shifted, f, out + x, width - x);
+}
+
+/* ========== SSE2: 8 PIXELS POR ITERAÇÃO ========== */
+
+static CONV_SSE2 inline __m128i conv_load8_sse2(const uint8_t* p) {
+    return _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)p), _mm_setzero_si128());
+}
+
+static CONV_SSE2 void conv_direct_row_sse2(const uint8_t* const* rows, const conv_mask_t* m, int16_t* out, int width) {
+    __m128i w[MATRIX_SIZE];
+    int x, i;
+
+    for (i = 0; i < m->ntaps; i++) w[i] = _mm_set1_epi16((int16_t)m->tap_w[i]);
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        __m128i acc = _mm_setzero_si128();
+        for (i = 0; i < m->ntaps; i++) {
+            __m128i p = conv_load8_sse2(rows[m->tap_r[i]] + x + m->tap_c[i]);
+            acc = _mm_adds_epi16(acc, _mm_mullo_epi16(p, w[i]));
+        }
+        _mm_storeu_si128((__m128i*)(out + x), acc);
+    }
+    if (x < width) conv_direct_tail(rows, m, out, x, width);
+}
+
+static CONV_SSE2 void conv_hpass_row_sse2(const uint8_t* p, const conv_factor_t* f, int16_t* out, int width) {
+    __m128i w[CONV_TAPS];
+    int x, i;
+
+    for (i = 0; i < f->nh; i++) w[i] = _mm_set1_epi16((int16_t)f->h_w[i]);
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        __m128i acc = _mm_setzero_si128();
+        for (i = 0; i < f->nh; i++) {
+            __m128i v = conv_load8_sse2(p + x + f->h_off[i]);
+            acc = _mm_adds_epi16(acc, _mm_mullo_epi16(v, w[i]));
+        }
+        _mm_storeu_si128((__m128i*)(out + x), acc);
+    }
+    if (x < width) conv_hpass_row_c(p + x, f, out + x, width - x);
+}
+
+static CONV_SSE2 void conv_vpass_row_sse2(const int16_t* const* h, const conv_factor_t* f, int16_t* out, int width) {
+    __m128i w[CONV_TAPS];
+    int x, i;
+
+    for (i = 0; i < f->nv; i++) w[i] = _mm_set1_epi16((int16_t)f->v_w[i]);
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        __m128i acc = _mm_setzero_si128();
+        for (i = 0; i < f->nv; i++) {
+            __m128i v = _mm_loadu_si128((const __m128i*)(h[i] + x));
+            acc = _mm_adds_epi16(acc, _mm_mullo_epi16(v, w[i]));
+        }
+        _mm_storeu_si128((__m128i*)(out + x), acc);
+    }
+    if (x < width) conv_vpass_tail(h, f, out, x, width);
+}
+
+// floor(sqrt(gx² + gy²)) em float: exato abaixo de 2^24 e, acima disso, o
+// resultado já passa de 255 e é saturado do mesmo jeito
+static CONV_SSE2 inline __m128i conv_isqrt_sse2(__m128i sum) {
+    return _mm_cvttps_epi32(_mm_sqrt_ps(_mm_cvtepi32_ps(sum)));
+}
+
+static CONV_SSE2 void conv_gradient_row_sse2(const int16_t* gx, const int16_t* gy, uint8_t* out, int width) {
+    int x;
+
+    for (x = 0; x + 8 <= width; x += 8) {
+        __m128i vx = _mm_loadu_si128((const __m128i*)(gx + x));
+        __m128i vy = _mm_loadu_si128((const __m128i*)(gy + x));
+        __m128i lo = _mm_unpacklo_epi16(vx, vy);
+        __m128i hi = _mm_unpackhi_epi16(vx, vy);
+        // madd soma os pares (gx*gx + gy*gy) em int32
+        __m128i mlo = conv_isqrt_sse2(_mm_madd_epi16(lo, lo));
+        __m128i mhi = conv_isqrt_sse2(_mm_madd_epi16(hi, hi));
+        __m128i m16 = _mm_packs_epi32(mlo, mhi);
+        _mm_storel_epi64((__m128i*)(out + x), _mm_packus_epi16(m16, m16));
+    }
+    if (x < width) conv_gradient_row_c(gx + x, gy + x, out + x, width - x);
+}
+
+static CONV_SSE2 void conv_laplacian_row_sse2(const int16_t* gx, uint8_t* out, int width) {
+    int x;
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m128i a = _mm_loadu_si128((const __m128i*)(gx + x));
+        __m128i b = _mm_loadu_si128((const __m128i*)(gx + x + 8));
+        // |a| = max(a, -a) com subtração saturada (-32768 vira 32767); packus satura em 255
+        a = _mm_max_epi16(a, _mm_subs_epi16(_mm_setzero_si128(), a));
+        b = _mm_max_epi16(b, _mm_subs_epi16(_mm_setzero_si128(), b));
+        _mm_storeu_si128((__m128i*)(out + x), _mm_packus_epi16(a, b));
+    }
+    if (x < width) conv_laplacian_row_c(gx + x, out + x, width - x);
+}
+
+static const conv_ops_t conv_ops_sse2_table = {
+    "sse2",
+    conv_direct_row_sse2,
+    conv_hpass_row_sse2,
+    conv_vpass_row_sse2,
+    conv_gradient_row_sse2,
+    conv_laplacian_row_sse2
+};
+
+const conv_ops_t* conv_ops_sse2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") ? &conv_ops_sse2_table : NULL;
+}
+
+/* ========== AVX2: 16 PIXELS POR ITERAÇÃO ========== */
+
+static CONV_AVX2 inline __m256i conv_load16_avx2(const uint8_t* p) {
+    return _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)p));
+}
+
+static CONV_AVX2 void conv_direct_row_avx2(const uint8_t* const* rows, const conv_mask_t* m, int16_t* out, int width) {
+    __m256i w[MATRIX_SIZE];
+    int x, i;
+
+    for (i = 0; i < m->ntaps; i++) w[i] = _mm256_set1_epi16((int16_t)m->tap_w[i]);
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m256i acc = _mm256_setzero_si256();
+        for (i = 0; i < m->ntaps; i++) {
+            __m256i p = conv_load16_avx2(rows[m->tap_r[i]] + x + m->tap_c[i]);
+            acc = _mm256_adds_epi16(acc, _mm256_mullo_epi16(p, w[i]));
+        }
+        _mm256_storeu_si256((__m256i*)(out + x), acc);
+    }
+    if (x < width) conv_direct_tail(rows, m, out, x, width);
+}
+
+static CONV_AVX2 void conv_hpass_row_avx2(const uint8_t* p, const conv_factor_t* f, int16_t* out, int width) {
+    __m256i w[CONV_TAPS];
+    int x, i;
+
+    for (i = 0; i < f->nh; i++) w[i] = _mm256_set1_epi16((int16_t)f->h_w[i]);
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m256i acc = _mm256_setzero_si256();
+        for (i = 0; i < f->nh; i++) {
+            __m256i v = conv_load16_avx2(p + x + f->h_off[i]);
+            acc = _mm256_adds_epi16(acc, _mm256_mullo_epi16(v, w[i]));
+        }
+        _mm256_storeu_si256((__m256i*)(out + x), acc);
+    }
+    if (x < width) conv_hpass_row_c(p + x, f, out + x, width - x);
+}
+
+static CONV_AVX2 void conv_vpass_row_avx2(const int16_t* const* h, const conv_factor_t* f, int16_t* out, int width) {
+    __m256i w[CONV_TAPS];
+    int x, i;
+
+    for (i = 0; i < f->nv; i++) w[i] = _mm256_set1_epi16((int16_t)f->v_w[i]);
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m256i acc = _mm256_setzero_si256();
+        for (i = 0; i < f->nv; i++) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(h[i] + x));
+            acc = _mm256_adds_epi16(acc, _mm256_mullo_epi16(v, w[i]));
+        }
+        _mm256_storeu_si256((__m256i*)(out + x), acc);
+    }
+    if (x < width) conv_vpass_tail(h, f, out, x, width);
+}
+
+static CONV_AVX2 inline __m256i conv_isqrt_avx2(__m256i sum) {
+    return _mm256_cvttps_epi32(_mm256_sqrt_ps(_mm256_cvtepi32_ps(sum)));
+}
+
+static CONV_AVX2 void conv_gradient_row_avx2(const int16_t* gx, const int16_t* gy, uint8_t* out, int width) {
+    int x;
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m256i vx = _mm256_loadu_si256((const __m256i*)(gx + x));
+        __m256i vy = _mm256_loadu_si256((const __m256i*)(gy + x));
+        // unpack e pack trabalham por metade de 128 bits, então a ordem volta sozinha
+        __m256i lo = _mm256_unpacklo_epi16(vx, vy);
+        __m256i hi = _mm256_unpackhi_epi16(vx, vy);
+        __m256i mlo = conv_isqrt_avx2(_mm256_madd_epi16(lo, lo));
+        __m256i mhi = conv_isqrt_avx2(_mm256_madd_epi16(hi, hi));
+        __m256i m16 = _mm256_packs_epi32(mlo, mhi);
+        __m256i m8 = _mm256_permute4x64_epi64(_mm256_packus_epi16(m16, m16), 0xD8);
+        _mm_storeu_si128((__m128i*)(out + x), _mm256_castsi256_si128(m8));
+    }
+    if (x < width) conv_gradient_row_c(gx + x, gy + x, out + x, width - x);
+}
+
+static CONV_AVX2 void conv_laplacian_row_avx2(const int16_t* gx, uint8_t* out, int width) {
+    int x;
+
+    for (x = 0; x + 32 <= width; x += 32) {
+        __m256i a = _mm256_loadu_si256((const __m256i*)(gx + x));
+        __m256i b = _mm256_loadu_si256((const __m256i*)(gx + x + 16));
+        __m256i m8;
+        // abs_epi16 deixaria -32768 negativo; a subtração saturada não
+        a = _mm256_max_epi16(a, _mm256_subs_epi16(_mm256_setzero_si256(), a));
+        b = _mm256_max_epi16(b, _mm256_subs_epi16(_mm256_setzero_si256(), b));
+        m8 = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), 0xD8);
+        _mm256_storeu_si256((__m256i*)(out + x), m8);
+    }
+    if (x < width) conv_laplacian_row_sse2(gx + x, out + x, width - x);
+}
+
+static const conv_ops_t conv_ops_avx2_table = {
+    "avx2",
+    conv_direct_row_avx2,
+    conv_hpass_row_avx2,
+    conv_vpass_row_avx2,
+    conv_gradient_row_avx2,
+    conv_laplacian_row_avx2
+};
+
+const conv_ops_t* conv_ops_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? &conv_ops_avx2_table : NULL;
+}
+
+#else
+
+const conv_ops_t* conv_ops_sse2(void) {
+    return NULL;
+}
+
+const conv_ops_t* conv_ops_avx2(void) {
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,130 @@
+#include <stdio.h>
+#include <string.h>
+#include "fpga_filter.h"
+
+// A FPGA trabalha com janelas de n x n pixels (n = size_code + 2); a janela útil
+// começa neste deslocamento dentro do layout 5x5 de filters.c (Roberts no canto,
+// os demais centralizados)
+static int fpga_window_offset(uint32_t size_code) {
+    return (conv_window_origin(size_code) == 0) ? 0 : (5 - (int)(size_code + 2)) / 2;
+}
+
+int load_filter_kernels(const hw_backend_t* hw, const int8_t* filter_kernel_gx, const int8_t* filter_kernel_gy,
+                        uint32_t size_code) {
+    int8_t gx[MATRIX_SIZE], gy[MATRIX_SIZE];
+    int n = (int)size_code + 2, off = fpga_window_offset(size_code);
+    int r, c;
+    struct Params params = {
+        .a = NULL,
+        .b = gx,
+        .opcode = 0,
+        .size = size_code,
+        .c = gy
+    };
+
+    memset(gx, 0, sizeof(gx));
+    memset(gy, 0, sizeof(gy));
+    for (r = 0; r < n; r++) {
+        for (c = 0; c < n; c++) {
+            gx[r * 5 + c] = filter_kernel_gx[(off + r) * 5 + off + c];
+            gy[r * 5 + c] = filter_kernel_gy[(off + r) * 5 + off + c];
+        }
+    }
+
+    if (hw->load_kernels(&params) != HW_SUCCESS) {
+        fprintf(stderr, "Falha no envio dos kernels para a FPGA\n");
+        return HW_SEND_FAIL;
+    }
+    return HW_SUCCESS;
+}
+
+int compute_convolution(const hw_backend_t* hw, const uint8_t* pixels, int columns, uint32_t size_code,
+                        int8_t laplaciano, uint8_t* out) {
+    struct Params params = {
+        .a = pixels,
+        .b = NULL,
+        .opcode = (laplaciano == 1) ? 6 : 7,
+        .size = size_code,
+        .c = NULL,
+        .columns = (uint32_t)columns
+    };
+    int sent = columns ? hw->submit_column(&params) : hw->submit(&params);
+
+    if (sent != HW_SUCCESS) {
+        fprintf(stderr, "Falha no envio de dados para a FPGA\n");
+        memset(out, 0, columns ? columns : 1);
+        return HW_SEND_FAIL;
+    }
+
+    if (hw->collect(out) != HW_SUCCESS) {
+        fprintf(stderr, "Falha na leitura dos resultados da FPGA\n");
+        memset(out, 0, columns ? columns : 1);
+        return HW_SEND_FAIL;
+    }
+    return HW_SUCCESS;
+}
+
+int fpga_filter_pass(const hw_backend_t* hw, const image_t* src, const int8_t* filter_gx, const int8_t* filter_gy,
+                     uint32_t size_code, int8_t laplaciano, conv_border_t border, image_t* result) {
+    conv_lines_t lines;
+    conv_kernel_t kernel;
+    uint8_t window[MATRIX_SIZE];
+    int x, y, r, c, streaming, columns, end;
+    int x0, x1, y0, y1;
+    int n = (int)size_code + 2, off = fpga_window_offset(size_code);
+
+    // Região em que a janela cabe inteira na imagem; fora dela o modo skip zera a saída
+    conv_kernel_init(&kernel, filter_gx, filter_gy, size_code, laplaciano);
+    conv_kernel_interior(&kernel, src->width, src->height, &x0, &x1, &y0, &y1);
+
+    if (conv_lines_init(&lines, src->data, src->width, src->height, src->stride, conv_window_origin(size_code), border) != 0) {
+        fprintf(stderr, "Falta de memória para o filtro (FPGA)\n");
+        return -1;
+    }
+    if (load_filter_kernels(hw, filter_gx, filter_gy, size_code) != HW_SUCCESS) {
+        conv_lines_free(&lines);
+        return -1;
+    }
+
+    for (y = 0; y < src->height; y++) {
+        uint8_t* out = image_row(result, y);
+
+        if (y % 40 == 0) printf("Processando linha %d/%d\n", y, src->height);
+        conv_lines_seek(&lines, y);
+        // A FPGA guarda a última janela: a linha começa com uma inteira e
+        // os pixels seguintes mandam só as colunas novas, em lotes
+        streaming = 0;
+        end = (border == CONV_BORDER_SKIP) ? x1 : src->width;
+
+        for (x = 0; x < src->width; x++) {
+            if (border == CONV_BORDER_SKIP && (y < y0 || y >= y1 || x < x0 || x >= x1)) {
+                out[x] = 0;
+                streaming = 0;
+                continue;
+            }
+            if (streaming) {
+                columns = (end - x < HW_MAX_COLUMNS) ? end - x : HW_MAX_COLUMNS;
+                for (c = 0; c < columns; c++) {
+                    for (r = 0; r < n; r++) window[c * n + r] = lines.rows[off + r][x + c + off + n - 1];
+                }
+                if (compute_convolution(hw, window, columns, size_code, laplaciano, &out[x]) != HW_SUCCESS) break;
+                x += columns - 1;
+                continue;
+            }
+            // Monta a janela n x n a partir do anel de linhas (sem testes de borda)
+            for (r = 0; r < n; r++) {
+                for (c = 0; c < n; c++) {
+                    window[r * n + c] = lines.rows[off + r][x + off + c];
+                }
+            }
+            if (compute_convolution(hw, window, 0, size_code, laplaciano, &out[x]) != HW_SUCCESS) break;
+            streaming = 1;
+        }
+        if (x < src->width) {
+            conv_lines_free(&lines);
+            return -1;
+        }
+    }
+    conv_lines_free(&lines);
+    return 0;
+}
@@ -0,0 +1,37 @@
+#ifndef FPGA_FILTER_H
+#define FPGA_FILTER_H
+#include <stdint.h>
+#include "interface.h"
+#include "hw_backend.h"
+#include "convolution.h"
+#include "image.h"
+
+/* ========== VARREDURA DA IMAGEM NA FPGA ==========
+ *
+ * O caminho da FPGA sobre qualquer backend de hw_backend.h: os kernels são
+ * gravados uma vez por filtro e cada linha começa com uma janela inteira;
+ * os pixels seguintes mandam só as colunas novas, em lotes de até
+ * HW_MAX_COLUMNS. As linhas vêm de conv_lines, então as bordas são as
+ * mesmas do motor da CPU; no skip a saída fora da região interna é 0.
+ */
+
+// Grava os kernels do filtro (layout 5x5 de filters.c) no canto superior
+// esquerdo, como o coprocessador espera. HW_SUCCESS ou HW_SEND_FAIL
+int load_filter_kernels(const hw_backend_t* hw, const int8_t* filter_kernel_gx, const int8_t* filter_kernel_gy,
+                        uint32_t size_code);
+
+// Convolução com os kernels gravados por load_filter_kernels. columns = 0:
+// pixels é a janela inteira de n x n (início de linha) e sai um pixel em out;
+// columns > 0: pixels traz essa quantidade de colunas de n que entram, uma após a
+// outra, à direita da janela anterior, e sai um pixel por coluna. A FPGA já devolve
+// o pixel final (no Laplaciano, o módulo saturado). HW_SUCCESS ou HW_SEND_FAIL
+int compute_convolution(const hw_backend_t* hw, const uint8_t* pixels, int columns, uint32_t size_code,
+                        int8_t laplaciano, uint8_t* out);
+
+// Uma varredura de src para result (mesmas dimensões). 0 = sucesso, -1 = falta
+// de memória ou falha na FPGA; uma falha no meio deixa a FPGA no meio de um
+// comando, então a varredura para
+int fpga_filter_pass(const hw_backend_t* hw, const image_t* src, const int8_t* filter_gx, const int8_t* filter_gy,
+                     uint32_t size_code, int8_t laplaciano, conv_border_t border, image_t* result);
+
+#endif
@@ -0,0 +1,208 @@
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "frame_ring.h"
+
+#define FRAME_RING_MAGIC 0x474e5246u    // "FRNG"
+#define FRAME_RING_HEADER 4096          // Cabeçalho e metadados ocupam a primeira página
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t reserved;
+    uint64_t timestamp_ns;
+} frame_ring_meta_t;
+
+struct frame_ring_shared {
+    uint32_t magic;                     // Gravado por último: o anel está pronto
+    int32_t width;
+    int32_t height;
+    int32_t stride;
+    int32_t slots;
+    uint32_t closed;
+    uint64_t frame_size;
+    // Cada contador só é escrito por um lado e fica na sua linha de cache
+    uint32_t head __attribute__((aligned(64)));     // Quadros publicados
+    uint32_t tail __attribute__((aligned(64)));     // Quadros devolvidos
+    frame_ring_meta_t meta[FRAME_RING_MAX_SLOTS] __attribute__((aligned(64)));
+};
+
+typedef char frame_ring_header_fits[(sizeof(struct frame_ring_shared) <= FRAME_RING_HEADER) ? 1 : -1];
+
+uint64_t frame_ring_now_ns(void) {
+    struct timespec t;
+
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return (uint64_t)t.tv_sec * 1000000000u + (uint64_t)t.tv_nsec;
+}
+
+static void frame_ring_pause(void) {
+    struct timespec t = { 0, FRAME_RING_POLL_US * 1000 };
+
+    nanosleep(&t, NULL);
+}
+
+// Potência de 2: head % slots segue contínuo quando o contador de 32 bits dá a volta
+static int frame_ring_slots_valid(int slots) {
+    return slots >= 1 && slots <= FRAME_RING_MAX_SLOTS && (slots & (slots - 1)) == 0;
+}
+
+static int frame_ring_map(frame_ring_t* r, int fd, size_t size) {
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+    if (map == MAP_FAILED) return -1;
+    r->shared = (frame_ring_shared_t*)map;
+    r->frames = (uint8_t*)map + FRAME_RING_HEADER;
+    r->map_size = size;
+    return 0;
+}
+
+/* ========== CRIAÇÃO E ABERTURA ========== */
+
+int frame_ring_create(frame_ring_t* r, const char* name, int width, int height, int slots) {
+    frame_ring_shared_t* s;
+    int fd;
+
+    memset(r, 0, sizeof(*r));
+    if (width <= 0 || height <= 0 || !frame_ring_slots_valid(slots)) return -1;
+    r->width = width;
+    r->height = height;
+    r->stride = (width + IMAGE_ALIGN - 1) / IMAGE_ALIGN * IMAGE_ALIGN;
+    r->slots = slots;
+    r->frame_size = (size_t)r->stride * height;
+
+    // Um anel antigo com o mesmo nome (de uma execução interrompida) é descartado
+    shm_unlink(name);
+    fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, (off_t)(FRAME_RING_HEADER + r->frame_size * slots)) != 0 ||
+        frame_ring_map(r, fd, FRAME_RING_HEADER + r->frame_size * slots) != 0) {
+        close(fd);
+        shm_unlink(name);
+        return -1;
+    }
+    close(fd);
+
+    // O ftruncate já zerou contadores e metadados
+    s = r->shared;
+    s->width = width;
+    s->height = height;
+    s->stride = r->stride;
+    s->slots = slots;
+    s->frame_size = r->frame_size;
+    __atomic_store_n(&s->magic, FRAME_RING_MAGIC, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int frame_ring_open(frame_ring_t* r, const char* name) {
+    frame_ring_shared_t* s;
+    struct stat st;
+    int fd;
+
+    memset(r, 0, sizeof(*r));
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return -1;
+    if (fstat(fd, &st) != 0 || st.st_size < FRAME_RING_HEADER || frame_ring_map(r, fd, (size_t)st.st_size) != 0) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+
+    s = r->shared;
+    if (__atomic_load_n(&s->magic, __ATOMIC_ACQUIRE) != FRAME_RING_MAGIC || !frame_ring_slots_valid(s->slots) ||
+        s->width <= 0 || s->height <= 0 || s->stride < s->width ||
+        s->frame_size != (uint64_t)s->stride * s->height ||
+        FRAME_RING_HEADER + s->frame_size * s->slots > (uint64_t)st.st_size) {
+        frame_ring_unmap(r);
+        return -1;
+    }
+    r->width = s->width;
+    r->height = s->height;
+    r->stride = s->stride;
+    r->slots = s->slots;
+    r->frame_size = (size_t)s->frame_size;
+    return 0;
+}
+
+void frame_ring_unmap(frame_ring_t* r) {
+    if (r->shared) munmap(r->shared, r->map_size);
+    memset(r, 0, sizeof(*r));
+}
+
+int frame_ring_unlink(const char* name) {
+    return shm_unlink(name) == 0 ? 0 : -1;
+}
+
+static void frame_ring_view(frame_ring_t* r, uint32_t index, frame_ring_frame_t* f) {
+    f->img.width = r->width;
+    f->img.height = r->height;
+    f->img.channels = 1;
+    f->img.stride = r->stride;
+    f->img.data = r->frames + (size_t)(index % (uint32_t)r->slots) * r->frame_size;
+}
+
+/* ========== PRODUTOR ========== */
+
+int frame_ring_begin_write(frame_ring_t* r, frame_ring_frame_t* f, int wait) {
+    frame_ring_shared_t* s = r->shared;
+    uint32_t head = __atomic_load_n(&s->head, __ATOMIC_RELAXED);
+
+    // A diferença sem sinal continua certa quando os contadores dão a volta
+    while (head - __atomic_load_n(&s->tail, __ATOMIC_ACQUIRE) >= (uint32_t)r->slots) {
+        if (!wait) return 1;
+        frame_ring_pause();
+    }
+    frame_ring_view(r, head, f);
+    return 0;
+}
+
+void frame_ring_end_write(frame_ring_t* r, const frame_ring_frame_t* f) {
+    frame_ring_shared_t* s = r->shared;
+    uint32_t head = __atomic_load_n(&s->head, __ATOMIC_RELAXED);
+    frame_ring_meta_t* m = &s->meta[head % (uint32_t)r->slots];
+
+    m->sequence = f->sequence;
+    m->timestamp_ns = f->timestamp_ns;
+    // Pixels e metadados ficam visíveis ao consumidor antes do novo head
+    __atomic_store_n(&s->head, head + 1, __ATOMIC_RELEASE);
+}
+
+void frame_ring_close(frame_ring_t* r) {
+    __atomic_store_n(&r->shared->closed, 1, __ATOMIC_RELEASE);
+}
+
+int frame_ring_pending(frame_ring_t* r) {
+    frame_ring_shared_t* s = r->shared;
+
+    return (int)(__atomic_load_n(&s->head, __ATOMIC_ACQUIRE) - __atomic_load_n(&s->tail, __ATOMIC_ACQUIRE));
+}
+
+/* ========== CONSUMIDOR ========== */
+
+int frame_ring_begin_read(frame_ring_t* r, frame_ring_frame_t* f) {
+    frame_ring_shared_t* s = r->shared;
+    uint32_t tail = __atomic_load_n(&s->tail, __ATOMIC_RELAXED);
+    frame_ring_meta_t* m;
+
+    while (__atomic_load_n(&s->head, __ATOMIC_ACQUIRE) == tail) {
+        // O produtor publica antes de fechar: fechado e ainda vazio é o fim
+        if (__atomic_load_n(&s->closed, __ATOMIC_ACQUIRE) &&
+            __atomic_load_n(&s->head, __ATOMIC_ACQUIRE) == tail) return 1;
+        frame_ring_pause();
+    }
+    m = &s->meta[tail % (uint32_t)r->slots];
+    frame_ring_view(r, tail, f);
+    f->sequence = m->sequence;
+    f->timestamp_ns = m->timestamp_ns;
+    return 0;
+}
+
+void frame_ring_end_read(frame_ring_t* r) {
+    frame_ring_shared_t* s = r->shared;
+    uint32_t tail = __atomic_load_n(&s->tail, __ATOMIC_RELAXED);
+
+    // O produtor só reaproveita o quadro depois deste release
+    __atomic_store_n(&s->tail, tail + 1, __ATOMIC_RELEASE);
+}
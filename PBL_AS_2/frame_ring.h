@@ -0,0 +1,71 @@
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+#include <stdint.h>
+#include "image.h"
+
+/* ========== ANEL DE QUADROS EM MEMÓRIA COMPARTILHADA ==========
+ *
+ * Quadros em escala de cinza trocados entre processos por um objeto POSIX
+ * (shm_open), sem arquivos e sem cópias: quem grava preenche o quadro direto
+ * na memória compartilhada e quem lê o usa no mesmo lugar. Um produtor e um
+ * consumidor por anel; os índices são contadores de 32 bits atualizados com
+ * acquire/release, sem locks (quem espera consulta o contador a cada
+ * FRAME_RING_POLL_US). Cada linha começa alinhada em IMAGE_ALIGN, como em image_t.
+ */
+#define FRAME_RING_SLOTS_DEFAULT 4
+#define FRAME_RING_MAX_SLOTS 64
+#define FRAME_RING_POLL_US 50
+
+typedef struct frame_ring_shared frame_ring_shared_t;
+
+typedef struct {
+    frame_ring_shared_t* shared;
+    uint8_t* frames;        // Primeiro quadro do mapeamento
+    size_t map_size;
+    size_t frame_size;      // Bytes entre dois quadros
+    int width;
+    int height;
+    int stride;
+    int slots;
+} frame_ring_t;
+
+// Quadro emprestado do anel: img aponta para a memória compartilhada e não
+// deve ser liberada. sequence e timestamp_ns (CLOCK_MONOTONIC, o mesmo em
+// todos os processos) viajam com o quadro, para medir a latência de ponta a ponta.
+typedef struct {
+    image_t img;
+    uint32_t sequence;
+    uint64_t timestamp_ns;
+} frame_ring_frame_t;
+
+// Cria o anel (substituindo um antigo de mesmo nome, ex.: "/pbl_entrada") com slots
+// quadros, potência de 2 até FRAME_RING_MAX_SLOTS. 0 = sucesso, -1 = erro
+int frame_ring_create(frame_ring_t* r, const char* name, int width, int height, int slots);
+// Abre um anel criado por outro processo. 0 = sucesso, -1 = não existe ou é inválido
+int frame_ring_open(frame_ring_t* r, const char* name);
+// Desfaz o mapeamento; o anel continua existindo até frame_ring_unlink
+void frame_ring_unmap(frame_ring_t* r);
+int frame_ring_unlink(const char* name);
+
+/* ========== PRODUTOR ========== */
+
+// Próximo quadro livre; espera o consumidor liberar um se o anel está cheio.
+// 0 = quadro em f, 1 = cheio (só com wait = 0)
+int frame_ring_begin_write(frame_ring_t* r, frame_ring_frame_t* f, int wait);
+// Publica o quadro de begin_write, com f->sequence e f->timestamp_ns
+void frame_ring_end_write(frame_ring_t* r, const frame_ring_frame_t* f);
+// Fim da sequência: o consumidor recebe 1 depois do último quadro
+void frame_ring_close(frame_ring_t* r);
+// Quadros publicados que o consumidor ainda não devolveu
+int frame_ring_pending(frame_ring_t* r);
+
+/* ========== CONSUMIDOR ========== */
+
+// Quadro publicado mais antigo, esperando se não há nenhum. 0 = quadro em f, 1 = fim da sequência
+int frame_ring_begin_read(frame_ring_t* r, frame_ring_frame_t* f);
+// Devolve o quadro de begin_read ao produtor
+void frame_ring_end_read(frame_ring_t* r);
+
+uint64_t frame_ring_now_ns(void);
+
+#endif
@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "interface.h"
+
+/* ========== GERADOR DE CONVOLUÇÕES ESPECIALIZADAS ==========
+ *
+ * Lê as tabelas de filters.c e escreve em stdout um arquivo C com uma função
+ * em linha reta por máscara: taps nulos somem, ±1 vira soma/subtração e
+ * potências de 2 viram deslocamentos. O Makefile roda este programa e compila
+ * a saída como convolution_spec.c.
+ */
+
+typedef struct {
+    const char* name;
+    const int8_t* taps;
+} gen_table_t;
+
+static const gen_table_t tables[] = {
+    {"sobel_gx_3x3", sobel_gx_3x3},
+    {"sobel_gy_3x3", sobel_gy_3x3},
+    {"sobel_gx_5x5", sobel_gx_5x5},
+    {"sobel_gy_5x5", sobel_gy_5x5},
+    {"prewitt_gx_3x3", prewitt_gx_3x3},
+    {"prewitt_gy_3x3", prewitt_gy_3x3},
+    {"roberts_gx_2x2", roberts_gx_2x2},
+    {"roberts_gy_2x2", roberts_gy_2x2},
+    {"laplaciano_5x5", laplaciano_5x5}
+};
+
+#define NUM_TABLES ((int)(sizeof(tables) / sizeof(tables[0])))
+
+// Expoente de |w| quando é potência de 2, senão -1
+static int gen_shift(int w) {
+    int s = 0;
+
+    w = abs(w);
+    if (w == 0 || (w & (w - 1)) != 0) return -1;
+    while (w > 1) {
+        w >>= 1;
+        s++;
+    }
+    return s;
+}
+
+static void gen_function(const gen_table_t* t) {
+    int used[5] = {0};
+    int i, r;
+
+    for (i = 0; i < MATRIX_SIZE; i++) {
+        if (t->taps[i] != 0) used[i / 5] = 1;
+    }
+
+    printf("// %s\n", t->name);
+    printf("static void conv_spec_%s(const uint8_t* const* rows, int16_t* out, int width) {\n", t->name);
+    for (r = 0; r < 5; r++) {
+        if (used[r]) printf("    const uint8_t* r%d = rows[%d];\n", r, r);
+    }
+    printf("    int x;\n\n");
+    printf("    for (x = 0; x < width; x++) {\n");
+    printf("        int acc = 0;\n");
+    for (i = 0; i < MATRIX_SIZE; i++) {
+        int w = t->taps[i];
+        int shift = gen_shift(w);
+        const char* op = (w < 0) ? "-=" : "+=";
+
+        if (w == 0) continue;
+        if (shift == 0) {
+            printf("        acc %s r%d[x + %d];\n", op, i / 5, i % 5);
+        } else if (shift > 0) {
+            printf("        acc %s r%d[x + %d] << %d;\n", op, i / 5, i % 5, shift);
+        } else {
+            printf("        acc %s r%d[x + %d] * %d;\n", op, i / 5, i % 5, abs(w));
+        }
+    }
+    printf("        out[x] = (int16_t)acc;\n");
+    printf("    }\n");
+    printf("}\n\n");
+}
+
+static void gen_entry(const gen_table_t* t) {
+    int i;
+
+    printf("    {{");
+    for (i = 0; i < MATRIX_SIZE; i++) {
+        printf("%s%d", i ? ", " : "", t->taps[i]);
+    }
+    printf("}, conv_spec_%s},\n", t->name);
+}
+
+int main(void) {
+    int i;
+
+    printf("/* Gerado por gen_kernels a partir de filters.c. Não editar. */\n");
+    printf("#include \"convolution_simd.h\"\n\n");
+    for (i = 0; i < NUM_TABLES; i++) {
+        gen_function(&tables[i]);
+    }
+
+    printf("const conv_spec_t conv_spec_table[] = {\n");
+    for (i = 0; i < NUM_TABLES; i++) {
+        gen_entry(&tables[i]);
+    }
+    printf("};\n\n");
+    printf("const int conv_spec_count = %d;\n", NUM_TABLES);
+    return 0;
+}
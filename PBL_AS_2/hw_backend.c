@@ -0,0 +1,53 @@
+#include <stdlib.h>
+#include <string.h>
+#include "hw_backend.h"
+
+/* ========== ROTINAS DE matrix_io.s ========== */
+
+#if defined(__arm__)
+
+static const hw_backend_t hw_backend_asm_table = {
+    "asm",
+    init_hw_access,
+    load_kernels,
+    send_all_data,
+    send_column,
+    read_all_results,
+    close_hw_access,
+    NULL
+};
+
+const hw_backend_t* hw_backend_asm(void) {
+    return &hw_backend_asm_table;
+}
+
+#else
+
+const hw_backend_t* hw_backend_asm(void) {
+    return NULL;
+}
+
+#endif
+
+/* ========== ESCOLHA DO BACKEND ========== */
+
+const hw_backend_t* hw_backend_find(const char* name) {
+    const hw_backend_t* candidates[2];
+    int i;
+
+    candidates[0] = hw_backend_asm();
+    candidates[1] = hw_backend_sim();
+    for (i = 0; i < 2; i++) {
+        if (candidates[i] && strcmp(name, candidates[i]->name) == 0) return candidates[i];
+    }
+    return NULL;
+}
+
+const hw_backend_t* hw_backend_default(void) {
+    const char* force = getenv("HW_BACKEND");
+    const hw_backend_t* b;
+
+    if (force && (b = hw_backend_find(force)) != NULL) return b;
+    b = hw_backend_asm();
+    return b ? b : hw_backend_sim();
+}
@@ -0,0 +1,49 @@
+#ifndef HW_BACKEND_H
+#define HW_BACKEND_H
+#include <stdint.h>
+#include "interface.h"
+
+/* ========== BACKENDS DO COPROCESSADOR ==========
+ *
+ * O caminho da FPGA fala com o coprocessador só por esta tabela: "asm" são
+ * as rotinas de matrix_io.s sobre a ponte leve (/dev/mem, só no DE1-SoC) e
+ * "sim" é um modelo em C, ciclo a ciclo, do ControlUnit e do Coprocessor
+ * ligado a uma cópia em C do protocolo de matrix_io.s. O simulador dá os
+ * mesmos resultados e o mesmo número de acessos à ponte em qualquer Linux,
+ * e estima o tempo que a placa levaria.
+ */
+
+// Pixels de saída que cabem numa leitura de data_out
+#define HW_MAX_COLUMNS 3
+
+typedef struct {
+    const char* name;
+    int (*init)(void);
+    // Grava os kernels b (Gx) e c (Gy) na FPGA; valem até o próximo load_kernels.
+    // Um kernel n x n (n = size + 2) fica no canto superior esquerdo do layout 5x5
+    int (*load_kernels)(const struct Params* p);
+    // Envia uma janela de n x n pixels, linha a linha (a, opcode e size de struct Params)
+    int (*submit)(const struct Params* p);
+    // Envia só as columns (até HW_MAX_COLUMNS) colunas de n pixels que entram,
+    // uma após a outra, à direita da última janela
+    int (*submit_column)(const struct Params* p);
+    // Lê os pixels de saída do último envio: 1 de submit, columns de submit_column
+    int (*collect)(uint8_t* result);
+    int (*close)(void);
+    // Mostra os contadores desde o último report e os zera (NULL = sem contadores)
+    void (*report)(const char* label);
+} hw_backend_t;
+
+// Backend pelo nome ("asm" ou "sim"); NULL se não existe ou não foi compilado
+const hw_backend_t* hw_backend_find(const char* name);
+// O indicado pela variável de ambiente HW_BACKEND, senão "asm" quando
+// compilado (ARM), senão "sim"
+const hw_backend_t* hw_backend_default(void);
+
+/* ========== IMPLEMENTAÇÕES ========== */
+
+// NULL fora do ARM, onde matrix_io.s não é montado
+const hw_backend_t* hw_backend_asm(void);
+const hw_backend_t* hw_backend_sim(void);
+
+#endif
@@ -0,0 +1,404 @@
+#include <stdio.h>
+#include <string.h>
+#include "hw_backend.h"
+
+/* ========== PARÂMETROS DO MODELO ========== */
+
+#define HW_SIM_CLOCK_HZ 50000000        // CLOCK_50 do ControlUnit (ghrd_top.v)
+#define HW_SIM_WRITE_CYCLES 2           // Escrita no PIO data_in pela ponte leve (postada)
+#define HW_SIM_READ_CYCLES 8            // Leitura do PIO data_out: ida e volta pela ponte
+#define HW_SIM_DELAY_CYCLES 1           // delay_loop de matrix_io.s (DELAY_CYCLES voltas no ARM)
+#define HW_SIM_POLL_LIMIT 1000000       // Leituras sem resposta até desistir (o asm esperaria para sempre)
+
+// Bits de controle de data_in (matrix_io.s)
+#define HW_BIT_HANDSHAKE (1u << 31)
+#define HW_BIT_START (1u << 30)
+#define HW_BIT_RESET (1u << 29)
+// Comandos em [18:16] do pulso de start
+#define HW_OP_NEW_ROW 0u                // Janela inteira
+#define HW_OP_LOAD_KERNELS 1u           // Gx/Gy
+#define HW_OP_NEXT_COLUMN 2u            // Lote de colunas que entram na janela
+
+/* ========== COPROCESSOR (COMBINACIONAL) ========== */
+
+// ConvolutionModule: soma com sinal das posições válidas para o tamanho, saturada em 16 bits
+static int16_t hw_sim_convolution(const uint8_t* a, const int8_t* k, int size) {
+    int n = size + 2, sum = 0, r, c;
+
+    for (r = 0; r < n; r++) {
+        for (c = 0; c < n; c++) sum += a[r * 5 + c] * k[r * 5 + c];
+    }
+    if (sum > 32767) return 32767;
+    if (sum < -32768) return -32768;
+    return (int16_t)sum;
+}
+
+// sqrt.v: aproximação binária bit a bit (piso da raiz)
+static uint16_t hw_sim_sqrt(uint32_t in) {
+    uint32_t x = 0, t;
+    int i;
+
+    for (i = 15; i >= 0; i--) {
+        t = x | (1u << i);
+        if (t * t <= in) x = t;
+    }
+    return (uint16_t)x;
+}
+
+// Coprocessor: process_Done só para os opcodes 6 (Laplaciano) e 7 (gradiente)
+static int hw_sim_coprocessor(int op_code, int size, const uint8_t* a, const int8_t* b, const int8_t* c,
+                              uint8_t* result) {
+    int16_t gx, gy, lap;
+    uint16_t mag;
+
+    memset(result, 0, MATRIX_SIZE);
+    if (op_code == 6) {
+        lap = hw_sim_convolution(a, b, size);
+        result[0] = (uint8_t)(lap & 0xFF);
+        result[1] = (uint8_t)((lap >> 8) & 0xFF);
+        return 1;
+    }
+    if (op_code == 7) {
+        gx = hw_sim_convolution(a, b, size);
+        gy = hw_sim_convolution(a, c, size);
+        mag = hw_sim_sqrt((uint32_t)((int64_t)gx * gx + (int64_t)gy * gy));
+        result[0] = (mag > 255) ? 255 : (uint8_t)mag;
+        return 1;
+    }
+    return 0;
+}
+
+/* ========== CONTROLUNIT (UM CICLO POR CHAMADA) ========== */
+
+enum { CU_IDLE = 0, CU_RECEIVING, CU_PROCESSING, CU_SENDING, CU_LOADING, CU_UNPACKING, CU_SHIFTING };
+
+typedef struct {
+    uint32_t data_in;
+    uint32_t data_out;              // Registrado, como no Verilog
+    int state;
+    int index;                      // 5 bits
+    int received;                   // Pixels já em pixel_buf
+    int expected;                   // Pixels do comando
+    int columns;                    // Resultados do comando (1 a 3)
+    int column;                     // Coluna do lote em processamento
+    int new_row;
+    int op_code;
+    int matrix_size;
+    int fpga_wait;                  // ACK: bit de sequência do último pedido atendido
+    int hps_ready_sync;             // 3 bits
+    uint8_t matrix_a[MATRIX_SIZE];
+    int8_t matrix_b[MATRIX_SIZE];
+    int8_t matrix_c[MATRIX_SIZE];
+    uint8_t pixel_buf[27];
+    uint8_t result_pixels[3];
+} control_unit_t;
+
+// Reset assíncrono (data_in[29], só no início de cada filtro): o que o bloco de
+// reset do Verilog zera (a janela e os kernels ficam)
+static void control_unit_reset(control_unit_t* cu) {
+    cu->state = CU_IDLE;
+    cu->index = 0;
+    cu->received = 0;
+    cu->column = 0;
+    cu->fpga_wait = 0;
+    cu->hps_ready_sync = 0;
+    cu->data_out = 0;
+}
+
+// out_pixel do Verilog: |Laplaciano| saturado ou o gradiente
+static uint8_t control_unit_pixel(int op_code, const uint8_t* result) {
+    int lap;
+
+    if (op_code != 6) return result[0];
+    lap = (int16_t)(result[0] | (result[1] << 8));
+    if (lap < 0) lap = -lap;
+    return (lap > 255) ? 255 : (uint8_t)lap;
+}
+
+// Uma borda de subida do clock. Todos os registradores são atualizados com
+// valores calculados a partir do estado anterior (atribuições <= do Verilog)
+static void control_unit_tick(control_unit_t* cu) {
+    uint32_t in = cu->data_in;
+    int sync2 = (cu->hps_ready_sync >> 2) & 1;
+    int request = sync2 != cu->fpga_wait;     // Handshake de duas fases
+    int state = cu->state, index = cu->index, received = cu->received, column = cu->column;
+    int command_in = (in >> 16) & 0x7, size_in = (in >> 19) & 0x3, columns_in = (in >> 24) & 0x3;
+    int side_in = size_in + 2, side = cu->matrix_size + 2;
+    int fpga_wait = cu->fpga_wait;
+    uint32_t data_out;
+    uint8_t result[MATRIX_SIZE];
+    uint8_t window[MATRIX_SIZE];
+    int i, r, c;
+
+    if (in & HW_BIT_RESET) {
+        control_unit_reset(cu);
+        return;
+    }
+
+    data_out = ((uint32_t)cu->fpga_wait << 31) | ((uint32_t)cu->columns << 24) |
+               ((uint32_t)cu->result_pixels[2] << 16) | ((uint32_t)cu->result_pixels[1] << 8) | cu->result_pixels[0];
+
+    switch (cu->state) {
+        case CU_IDLE:
+            break;
+
+        case CU_LOADING:
+            if (request) {
+                fpga_wait = sync2;
+                cu->matrix_b[cu->index] = (int8_t)((in >> 8) & 0xFF);
+                cu->matrix_c[cu->index] = (int8_t)((in >> 21) & 0xFF);
+                index = (cu->index + 1) & 31;
+                if (cu->index == 24) {
+                    index = 0;
+                    state = CU_IDLE;
+                }
+            }
+            break;
+
+        case CU_RECEIVING:
+            if (request) {
+                fpga_wait = sync2;
+                cu->pixel_buf[cu->received] = (uint8_t)(in & 0xFF);
+                cu->pixel_buf[cu->received + 1] = (uint8_t)((in >> 8) & 0xFF);
+                cu->pixel_buf[cu->received + 2] = (uint8_t)((in >> 16) & 0xFF);
+                received = cu->received + 3;
+                if (cu->received + 3 >= cu->expected) state = cu->new_row ? CU_UNPACKING : CU_SHIFTING;
+            }
+            break;
+
+        case CU_UNPACKING:
+            for (r = 0; r < side; r++) {
+                for (c = 0; c < side; c++) cu->matrix_a[r * 5 + c] = cu->pixel_buf[r * side + c];
+            }
+            state = CU_PROCESSING;
+            break;
+
+        case CU_SHIFTING:
+            // O deslocamento lê a janela anterior; a coluna nova sobrescreve a posição n - 1
+            memcpy(window, cu->matrix_a, MATRIX_SIZE);
+            for (i = 0; i < MATRIX_SIZE; i++) {
+                if (i % 5 != 4) cu->matrix_a[i] = window[i + 1];
+            }
+            for (r = 0; r < side; r++) cu->matrix_a[r * 5 + side - 1] = cu->pixel_buf[cu->column * side + r];
+            state = CU_PROCESSING;
+            break;
+
+        case CU_PROCESSING:
+            if (hw_sim_coprocessor(cu->op_code, cu->matrix_size, cu->matrix_a, cu->matrix_b, cu->matrix_c, result)) {
+                cu->result_pixels[cu->column] = control_unit_pixel(cu->op_code, result);
+                column = (cu->column + 1) & 3;
+                state = (cu->column + 1 == cu->columns) ? CU_SENDING : CU_SHIFTING;
+            }
+            break;
+
+        case CU_SENDING:
+            // Sem passar por IDLE: o próximo lote repete o último comando de colunas
+            if (request) {
+                fpga_wait = sync2;
+                received = 0;
+                column = 0;
+                cu->new_row = 0;
+                state = CU_RECEIVING;
+            }
+            break;
+    }
+
+    // Comando novo: em IDLE ou antes do primeiro pixel de um lote
+    if ((in & HW_BIT_START) && (cu->state == CU_IDLE || (cu->state == CU_RECEIVING && cu->received == 0))) {
+        index = 0;
+        received = 0;
+        column = 0;
+        if (command_in == (int)HW_OP_LOAD_KERNELS) {
+            state = CU_LOADING;
+        } else {
+            cu->op_code = (in >> 21) & 0x7;
+            cu->matrix_size = size_in;
+            cu->new_row = command_in == (int)HW_OP_NEW_ROW;
+            cu->columns = cu->new_row ? 1 : columns_in;
+            cu->expected = cu->new_row ? side_in * side_in : columns_in * side_in;
+            state = CU_RECEIVING;
+        }
+    }
+
+    cu->hps_ready_sync = ((cu->hps_ready_sync << 1) | (int)(in >> 31)) & 0x7;
+    cu->fpga_wait = fpga_wait;
+    cu->data_out = data_out;
+    cu->state = state;
+    cu->index = index;
+    cu->received = received;
+    cu->column = column;
+}
+
+/* ========== LADO DO HPS (CÓPIA DE matrix_io.s) ========== */
+
+typedef struct {
+    control_unit_t cu;
+    unsigned long long cycles;
+    unsigned long long reads;
+    unsigned long long writes;
+    unsigned long long windows;
+    uint32_t last_command;          // last_command de matrix_io.s
+    uint32_t hps_seq;               // hps_seq de matrix_io.s (0 ou bit 31)
+} hw_sim_t;
+
+static hw_sim_t sim;
+
+static void hw_sim_clock(int cycles) {
+    while (cycles-- > 0) {
+        control_unit_tick(&sim.cu);
+        sim.cycles++;
+    }
+}
+
+static void hw_sim_write(uint32_t value) {
+    sim.cu.data_in = value;
+    sim.writes++;
+    hw_sim_clock(HW_SIM_WRITE_CYCLES);
+}
+
+static uint32_t hw_sim_read(void) {
+    sim.reads++;
+    hw_sim_clock(HW_SIM_READ_CYCLES);
+    return sim.cu.data_out;
+}
+
+// Espera o bit 31 de data_out alcançar a sequência; devolve a leitura que o viu
+static int hw_sim_wait_ack(uint32_t* seen) {
+    long polls;
+    uint32_t v;
+
+    for (polls = 0; polls < HW_SIM_POLL_LIMIT; polls++) {
+        v = hw_sim_read();
+        if ((v & HW_BIT_HANDSHAKE) == sim.hps_seq) {
+            if (seen) *seen = v;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+// handshake_send: inverte a sequência, valor com ela no bit 31, espera o ACK igual
+static int hw_sim_handshake_send(uint32_t value) {
+    sim.hps_seq ^= HW_BIT_HANDSHAKE;
+    hw_sim_write(value | sim.hps_seq);
+    return hw_sim_wait_ack(NULL);
+}
+
+// handshake_receive: inverte a sequência e espera a palavra com o ACK igual
+static int hw_sim_handshake_receive(uint32_t* value) {
+    sim.hps_seq ^= HW_BIT_HANDSHAKE;
+    hw_sim_write(sim.hps_seq);
+    return hw_sim_wait_ack(value);
+}
+
+static int hw_sim_init(void) {
+    memset(&sim, 0, sizeof(sim));
+    sim.last_command = 0xFFFFFFFFu;
+    control_unit_reset(&sim.cu);
+    return HW_SUCCESS;
+}
+
+// start_command: pulso de start com os campos do comando
+static void hw_sim_command(uint32_t command) {
+    sim.last_command = command;
+    hw_sim_write(HW_BIT_START | command | sim.hps_seq);
+    hw_sim_write(sim.hps_seq);
+}
+
+// start_session: pulso de reset, espera e o comando
+static void hw_sim_session(uint32_t command) {
+    hw_sim_write(HW_BIT_RESET);
+    hw_sim_write(0);
+    sim.hps_seq = 0;
+    sim.last_command = 0xFFFFFFFFu;
+    hw_sim_clock(HW_SIM_DELAY_CYCLES);
+    hw_sim_command(command);
+}
+
+// Como send_pixels: três pixels por palavra, [23:16] | [15:8] | [7:0]
+static int hw_sim_send_pixels(const uint8_t* pixels, int count) {
+    int i;
+
+    for (i = 0; i < count; i += 3) {
+        uint32_t word = pixels[i];
+
+        if (i + 1 < count) word |= (uint32_t)pixels[i + 1] << 8;
+        if (i + 2 < count) word |= (uint32_t)pixels[i + 2] << 16;
+        if (hw_sim_handshake_send(word) != 0) return HW_SEND_FAIL;
+    }
+    return HW_SUCCESS;
+}
+
+static int hw_sim_load_kernels(const struct Params* p) {
+    int i;
+
+    // Como load_kernels: 25 palavras [28:21] Gy | [15:8] Gx
+    hw_sim_session(HW_OP_LOAD_KERNELS << 16);
+    for (i = 0; i < MATRIX_SIZE; i++) {
+        uint32_t word = ((uint32_t)(uint8_t)p->b[i] << 8) | ((uint32_t)(uint8_t)p->c[i] << 21);
+
+        if (hw_sim_handshake_send(word) != 0) return HW_SEND_FAIL;
+    }
+    return HW_SUCCESS;
+}
+
+static int hw_sim_submit(const struct Params* p) {
+    int n = (int)p->size + 2;
+
+    // Como send_all_data: comando [23:21] opcode | [20:19] size e n x n pixels
+    hw_sim_command((HW_OP_NEW_ROW << 16) | (p->size << 19) | (p->opcode << 21));
+    if (hw_sim_send_pixels(p->a, n * n) != HW_SUCCESS) return HW_SEND_FAIL;
+    sim.windows++;
+    return HW_SUCCESS;
+}
+
+static int hw_sim_submit_column(const struct Params* p) {
+    int n = (int)p->size + 2;
+    uint32_t command = (HW_OP_NEXT_COLUMN << 16) | (p->size << 19) | (p->opcode << 21) | (p->columns << 24);
+
+    // Como send_column: comando com [25:24] colunas, só se mudou, e n pixels por coluna
+    if (command != sim.last_command) hw_sim_command(command);
+    if (hw_sim_send_pixels(p->a, n * (int)p->columns) != HW_SUCCESS) return HW_SEND_FAIL;
+    sim.windows += p->columns;
+    return HW_SUCCESS;
+}
+
+// Como read_all_results: uma palavra, [25:24] quantos | [23:0] até três pixels
+static int hw_sim_collect(uint8_t* result) {
+    uint32_t v;
+    int i;
+
+    if (hw_sim_handshake_receive(&v) != 0) return HW_SEND_FAIL;
+    for (i = 0; i < (int)((v >> 24) & 0x3); i++) result[i] = (uint8_t)((v >> (8 * i)) & 0xFF);
+    return HW_SUCCESS;
+}
+
+static int hw_sim_close(void) {
+    return HW_SUCCESS;
+}
+
+static void hw_sim_report(const char* label) {
+    double windows = sim.windows ? (double)sim.windows : 1.0;
+    double seconds = (double)sim.cycles / HW_SIM_CLOCK_HZ;
+
+    printf("%s (simulador): %llu janelas, %.1f escritas e %.1f leituras por janela, %.0f ciclos por janela\n",
+           label, sim.windows, sim.writes / windows, sim.reads / windows, sim.cycles / windows);
+    printf("%s (simulador): %.3f s na placa a %d MHz (%.0f janelas/s)\n", label, seconds,
+           HW_SIM_CLOCK_HZ / 1000000, seconds > 0 ? sim.windows / seconds : 0.0);
+    sim.cycles = sim.reads = sim.writes = sim.windows = 0;
+}
+
+static const hw_backend_t hw_backend_sim_table = {
+    "sim",
+    hw_sim_init,
+    hw_sim_load_kernels,
+    hw_sim_submit,
+    hw_sim_submit_column,
+    hw_sim_collect,
+    hw_sim_close,
+    hw_sim_report
+};
+
+const hw_backend_t* hw_backend_sim(void) {
+    return &hw_backend_sim_table;
+}
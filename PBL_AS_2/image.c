@@ -0,0 +1,29 @@
+#include <stdlib.h>
+#include <string.h>
+#include "image.h"
+
+int image_alloc(image_t* img, int width, int height, int channels) {
+    size_t stride;
+    void* data;
+
+    img->data = NULL;
+    if (width <= 0 || height <= 0 || channels <= 0) return -1;
+
+    // Arredonda a linha para o próximo múltiplo de IMAGE_ALIGN
+    stride = ((size_t)width * channels + IMAGE_ALIGN - 1) & ~(size_t)(IMAGE_ALIGN - 1);
+    if (stride > INT32_MAX) return -1;
+    if (posix_memalign(&data, IMAGE_ALIGN, stride * (size_t)height) != 0) return -1;
+    memset(data, 0, stride * (size_t)height);
+
+    img->width = width;
+    img->height = height;
+    img->channels = channels;
+    img->stride = (int)stride;
+    img->data = data;
+    return 0;
+}
+
+void image_free(image_t* img) {
+    free(img->data);
+    img->data = NULL;
+}
@@ -0,0 +1,29 @@
+#ifndef IMAGE_H
+#define IMAGE_H
+#include <stddef.h>
+#include <stdint.h>
+
+/* ========== DESCRITOR DE IMAGEM ========== */
+
+// Alinhamento do início de cada linha: cobre cargas AVX2/NEON e a linha de cache
+#define IMAGE_ALIGN 64
+
+// Imagem de qualquer resolução em memória contígua. As linhas começam a cada
+// 'stride' bytes (múltiplo de IMAGE_ALIGN); os bytes após width * channels são preenchimento.
+typedef struct {
+    int width;
+    int height;
+    int channels;           // 1 = escala de cinza, 3 = RGB intercalado
+    int stride;             // Bytes entre o início de duas linhas consecutivas
+    uint8_t* data;          // Alinhado em IMAGE_ALIGN
+} image_t;
+
+// Aloca a imagem zerada (0 = sucesso, -1 = falta de memória ou tamanho inválido)
+int image_alloc(image_t* img, int width, int height, int channels);
+void image_free(image_t* img);
+
+static inline uint8_t* image_row(const image_t* img, int y) {
+    return img->data + (size_t)y * img->stride;
+}
+
+#endif
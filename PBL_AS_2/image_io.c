@@ -0,0 +1,207 @@
+// Arquivos grandes também no ARM de 32 bits (off_t de 64 bits em fopen/ftruncate/mmap)
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "image_io.h"
+#include "png_write.h"
+
+int image_format_parse(const char* name, image_format_t* format) {
+    if (strcmp(name, "png") == 0) *format = IMAGE_FORMAT_PNG;
+    else if (strcmp(name, "pgm") == 0) *format = IMAGE_FORMAT_PGM;
+    else if (strcmp(name, "raw") == 0) *format = IMAGE_FORMAT_RAW;
+    else return -1;
+    return 0;
+}
+
+const char* image_format_ext(image_format_t format) {
+    switch (format) {
+        case IMAGE_FORMAT_PGM: return "pgm";
+        case IMAGE_FORMAT_RAW: return "raw";
+        default:               return "png";
+    }
+}
+
+/* ========== PNG ========== */
+
+static int png_level = IMAGE_PNG_LEVEL_DEFAULT;
+static thread_pool_t* png_pool = NULL;
+static pthread_mutex_t png_pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void image_png_set_level(int level) {
+    png_level = level;
+}
+
+void image_png_set_pool(thread_pool_t* pool) {
+    png_pool = pool;
+}
+
+int image_write_png(const char* filename, const image_t* img) {
+    int ret;
+
+    // O pool comprime uma imagem por vez: se outra escritora já está com ele,
+    // esta comprime numa faixa só, na própria thread, em vez de esperar
+    if (png_pool && pthread_mutex_trylock(&png_pool_lock) == 0) {
+        ret = png_write(filename, img, png_level, png_pool);
+        pthread_mutex_unlock(&png_pool_lock);
+        return ret;
+    }
+    return png_write(filename, img, png_level, NULL);
+}
+
+/* ========== SEM COMPRESSÃO ========== */
+
+// Cria o arquivo já com o tamanho final, mapeia e copia cabeçalho e linhas
+// direto para o cache de páginas: sem buffer do stdio e sem uma chamada write por linha
+static int image_write_mapped(const char* filename, const char* header, size_t header_len, const image_t* img) {
+    size_t row_bytes = (size_t)img->width * img->channels;
+    size_t total = header_len + row_bytes * (size_t)img->height;
+    uint8_t* map;
+    int fd, y, ret = 0;
+
+    fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, (off_t)total) != 0) {
+        close(fd);
+        return -1;
+    }
+    map = (uint8_t*)mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+
+    memcpy(map, header, header_len);
+    if ((size_t)img->stride == row_bytes) {
+        memcpy(map + header_len, img->data, row_bytes * (size_t)img->height);
+    } else {
+        for (y = 0; y < img->height; y++) {
+            memcpy(map + header_len + (size_t)y * row_bytes, image_row(img, y), row_bytes);
+        }
+    }
+
+    // O munmap não garante a gravação; quem precisar de durabilidade chama fsync depois
+    if (munmap(map, total) != 0) ret = -1;
+    if (close(fd) != 0) ret = -1;
+    return ret;
+}
+
+int image_write_pgm(const char* filename, const image_t* img) {
+    char header[64];
+    int len;
+
+    if (img->channels != 1) return -1;
+    len = snprintf(header, sizeof(header), "P5\n%d %d\n255\n", img->width, img->height);
+    return image_write_mapped(filename, header, (size_t)len, img);
+}
+
+int image_write_raw(const char* filename, const image_t* img) {
+    return image_write_mapped(filename, "", 0, img);
+}
+
+int image_write(const char* filename, const image_t* img, image_format_t format) {
+    switch (format) {
+        case IMAGE_FORMAT_PGM: return image_write_pgm(filename, img);
+        case IMAGE_FORMAT_RAW: return image_write_raw(filename, img);
+        default:               return image_write_png(filename, img);
+    }
+}
+
+/* ========== LEITURA E GRAVAÇÃO EM SEQUÊNCIA ========== */
+
+// Próximo número do cabeçalho PGM, pulando espaços e comentários; consome um
+// único caractere depois dele (o separador antes dos pixels, no caso do maxval)
+static int image_pgm_read_int(FILE* f, int* value) {
+    int c = fgetc(f);
+    int v = 0;
+
+    while (c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '#') {
+        if (c == '#') {
+            while (c != '\n' && c != EOF) c = fgetc(f);
+        }
+        c = fgetc(f);
+    }
+    if (c < '0' || c > '9') return -1;
+    while (c >= '0' && c <= '9') {
+        if (v > (INT_MAX - 9) / 10) return -1;
+        v = v * 10 + (c - '0');
+        c = fgetc(f);
+    }
+    if (c == EOF) return -1;
+    *value = v;
+    return 0;
+}
+
+int image_stream_open_read(image_stream_t* s, const char* filename, int raw_width, int raw_height) {
+    int maxval;
+
+    s->f = fopen(filename, "rb");
+    if (!s->f) return -1;
+
+    if (raw_width > 0 && raw_height > 0) {
+        s->width = raw_width;
+        s->height = raw_height;
+        return 0;
+    }
+    if (fgetc(s->f) != 'P' || fgetc(s->f) != '5' ||
+        image_pgm_read_int(s->f, &s->width) != 0 || image_pgm_read_int(s->f, &s->height) != 0 ||
+        image_pgm_read_int(s->f, &maxval) != 0 || maxval != 255 || s->width <= 0 || s->height <= 0) {
+        fclose(s->f);
+        s->f = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int image_stream_open_write(image_stream_t* s, const char* filename, image_format_t format, int width, int height) {
+    if (format == IMAGE_FORMAT_PNG) return -1;
+    s->f = fopen(filename, "wb");
+    if (!s->f) return -1;
+    s->width = width;
+    s->height = height;
+    if (format == IMAGE_FORMAT_PGM && fprintf(s->f, "P5\n%d %d\n255\n", width, height) < 0) {
+        fclose(s->f);
+        s->f = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int image_stream_read_rows(image_stream_t* s, uint8_t* dst, int stride, int rows) {
+    size_t row_bytes = (size_t)s->width;
+    int y;
+
+    // Linhas contíguas (stride == width) saem numa única leitura
+    if ((size_t)stride == row_bytes) {
+        return fread(dst, row_bytes, (size_t)rows, s->f) == (size_t)rows ? 0 : -1;
+    }
+    for (y = 0; y < rows; y++) {
+        if (fread(dst + (size_t)y * stride, 1, row_bytes, s->f) != row_bytes) return -1;
+    }
+    return 0;
+}
+
+int image_stream_write_rows(image_stream_t* s, const uint8_t* src, int stride, int rows) {
+    size_t row_bytes = (size_t)s->width;
+    int y;
+
+    if ((size_t)stride == row_bytes) {
+        return fwrite(src, row_bytes, (size_t)rows, s->f) == (size_t)rows ? 0 : -1;
+    }
+    for (y = 0; y < rows; y++) {
+        if (fwrite(src + (size_t)y * stride, 1, row_bytes, s->f) != row_bytes) return -1;
+    }
+    return 0;
+}
+
+int image_stream_close(image_stream_t* s) {
+    int ret = 0;
+
+    if (s->f && fclose(s->f) != 0) ret = -1;
+    s->f = NULL;
+    return ret;
+}
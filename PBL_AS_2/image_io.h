@@ -0,0 +1,56 @@
+#ifndef IMAGE_IO_H
+#define IMAGE_IO_H
+#include <stdio.h>
+#include "image.h"
+#include "thread_pool.h"
+
+/* ========== GRAVAÇÃO DE IMAGENS EM ESCALA DE CINZA ========== */
+
+typedef enum {
+    IMAGE_FORMAT_PNG = 0,   // Deflate (zlib) em faixas paralelas, nível ajustável
+    IMAGE_FORMAT_PGM,       // PGM binário (P5): cabeçalho de texto + pixels, sem compressão
+    IMAGE_FORMAT_RAW        // Só os pixels, width * height bytes, linha a linha
+} image_format_t;
+
+// Nível zlib padrão (0 a 9); valores maiores comprimem mais e demoram mais
+#define IMAGE_PNG_LEVEL_DEFAULT 6
+
+// Converte "png", "pgm" ou "raw" (retorna -1 se inválido)
+int image_format_parse(const char* name, image_format_t* format);
+// Extensão do arquivo, sem o ponto
+const char* image_format_ext(image_format_t format);
+
+// Nível de compressão e pool de todas as gravações PNG (png_write.h). Ficam em
+// variáveis globais, então só podem mudar sem nenhuma gravação em andamento.
+// O pool deve ser exclusivo das gravações: não pode ser o mesmo da convolução.
+void image_png_set_level(int level);
+void image_png_set_pool(thread_pool_t* pool);
+
+// Todas retornam 0 = sucesso, -1 = erro (errno indica a causa nos formatos sem compressão)
+int image_write_png(const char* filename, const image_t* img);
+int image_write_pgm(const char* filename, const image_t* img);
+int image_write_raw(const char* filename, const image_t* img);
+int image_write(const char* filename, const image_t* img, image_format_t format);
+
+/* ========== LEITURA E GRAVAÇÃO EM SEQUÊNCIA ==========
+ *
+ * PGM (P5, maxval 255) ou raw aberto para ler ou gravar linhas em ordem,
+ * sem nunca ter a imagem inteira em memória. Arquivos acima de 2 GB
+ * funcionam também no ARM de 32 bits.
+ */
+typedef struct {
+    FILE* f;
+    int width;
+    int height;
+} image_stream_t;
+
+// raw_width/raw_height > 0 abre um raw com essas dimensões; senão lê o cabeçalho PGM.
+// 0 = sucesso, -1 = erro
+int image_stream_open_read(image_stream_t* s, const char* filename, int raw_width, int raw_height);
+// Cria o arquivo e grava o cabeçalho (PGM) ou nada (raw); PNG não dá para gravar em partes
+int image_stream_open_write(image_stream_t* s, const char* filename, image_format_t format, int width, int height);
+int image_stream_read_rows(image_stream_t* s, uint8_t* dst, int stride, int rows);
+int image_stream_write_rows(image_stream_t* s, const uint8_t* src, int stride, int rows);
+int image_stream_close(image_stream_t* s);
+
+#endif
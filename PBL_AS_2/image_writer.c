@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "image_writer.h"
+
+#define IMAGE_WRITER_NAME 128
+
+typedef struct {
+    char filename[IMAGE_WRITER_NAME];
+    image_t img;
+    image_format_t format;
+} image_writer_job_t;
+
+struct image_writer {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;       // Há quadro na fila (ou encerramento)
+    pthread_cond_t not_full;        // Abriu vaga na fila
+    pthread_cond_t idle;            // Fila vazia e nenhuma gravação em andamento
+    pthread_t* workers;
+    int nworkers;
+    image_writer_job_t* queue;      // Anel de 'depth' posições
+    int depth;
+    int head;                       // Próximo quadro a gravar
+    int count;                      // Quadros na fila
+    int busy;                       // Gravações em andamento
+    image_t* spare;                 // Buffers já gravados, prontos para acquire
+    int nspare;
+    int max_spare;
+    int errors;
+    int shutdown;
+};
+
+/* ========== REAPROVEITAMENTO DE BUFFERS ========== */
+
+// Devolve o buffer à lista (chamada com o lock preso); se ela está cheia, o
+// mais antigo é liberado
+static void image_writer_recycle(image_writer_t* w, image_t* img) {
+    if (w->max_spare == 0) {
+        image_free(img);
+        return;
+    }
+    if (w->nspare == w->max_spare) {
+        image_free(&w->spare[0]);
+        memmove(w->spare, w->spare + 1, sizeof(image_t) * (size_t)(w->nspare - 1));
+        w->nspare--;
+    }
+    w->spare[w->nspare++] = *img;
+    img->data = NULL;
+}
+
+int image_writer_acquire(image_writer_t* w, image_t* img, int width, int height, int channels) {
+    int i;
+
+    pthread_mutex_lock(&w->lock);
+    for (i = w->nspare - 1; i >= 0; i--) {
+        image_t* s = &w->spare[i];
+
+        if (s->width == width && s->height == height && s->channels == channels) {
+            *img = *s;
+            w->spare[i] = w->spare[--w->nspare];
+            pthread_mutex_unlock(&w->lock);
+            return 0;
+        }
+    }
+    pthread_mutex_unlock(&w->lock);
+    return image_alloc(img, width, height, channels);
+}
+
+/* ========== GRAVAÇÃO ========== */
+
+static void image_writer_run(image_writer_t* w, image_writer_job_t* job) {
+    int ret = image_write(job->filename, &job->img, job->format);
+
+    if (ret != 0) {
+        printf("Erro ao salvar %s\n", job->filename);
+    } else {
+        printf("Imagem salva: %s\n", job->filename);
+    }
+    pthread_mutex_lock(&w->lock);
+    if (ret != 0) w->errors++;
+    image_writer_recycle(w, &job->img);
+    pthread_mutex_unlock(&w->lock);
+}
+
+static void* image_writer_worker(void* data) {
+    image_writer_t* w = data;
+    image_writer_job_t job;
+
+    pthread_mutex_lock(&w->lock);
+    while (1) {
+        while (!w->shutdown && w->count == 0) {
+            pthread_cond_wait(&w->not_empty, &w->lock);
+        }
+        // No encerramento a fila é esvaziada antes de sair
+        if (w->count == 0) break;
+
+        job = w->queue[w->head];
+        w->head = (w->head + 1) % w->depth;
+        w->count--;
+        w->busy++;
+        pthread_cond_signal(&w->not_full);
+        pthread_mutex_unlock(&w->lock);
+
+        image_writer_run(w, &job);
+
+        pthread_mutex_lock(&w->lock);
+        if (--w->busy == 0 && w->count == 0) {
+            pthread_cond_broadcast(&w->idle);
+        }
+    }
+    pthread_mutex_unlock(&w->lock);
+    return NULL;
+}
+
+int image_writer_submit(image_writer_t* w, const char* filename, image_t* img, image_format_t format) {
+    image_writer_job_t job;
+
+    snprintf(job.filename, sizeof(job.filename), "%s", filename);
+    job.img = *img;
+    job.format = format;
+    img->data = NULL;
+
+    if (w->nworkers == 0) {
+        image_writer_run(w, &job);
+        return 0;
+    }
+
+    pthread_mutex_lock(&w->lock);
+    while (w->count == w->depth) {
+        pthread_cond_wait(&w->not_full, &w->lock);
+    }
+    w->queue[(w->head + w->count) % w->depth] = job;
+    w->count++;
+    pthread_cond_signal(&w->not_empty);
+    pthread_mutex_unlock(&w->lock);
+    return 0;
+}
+
+void image_writer_flush(image_writer_t* w) {
+    pthread_mutex_lock(&w->lock);
+    while (w->count > 0 || w->busy > 0) {
+        pthread_cond_wait(&w->idle, &w->lock);
+    }
+    pthread_mutex_unlock(&w->lock);
+}
+
+int image_writer_errors(image_writer_t* w) {
+    int errors;
+
+    pthread_mutex_lock(&w->lock);
+    errors = w->errors;
+    pthread_mutex_unlock(&w->lock);
+    return errors;
+}
+
+/* ========== CRIAÇÃO E ENCERRAMENTO ========== */
+
+image_writer_t* image_writer_create(int threads, int depth) {
+    image_writer_t* w;
+    int i;
+
+    if (threads < 0) threads = 0;
+    if (depth < 1) depth = 1;
+
+    w = calloc(1, sizeof(*w));
+    if (!w) return NULL;
+    w->depth = depth;
+    // Cabe tudo o que pode estar em trânsito: a fila, o que está sendo gravado
+    // e um par de resultados do lado de quem produz
+    w->max_spare = depth + threads + 2;
+    w->queue = calloc((size_t)depth, sizeof(image_writer_job_t));
+    w->spare = calloc((size_t)w->max_spare, sizeof(image_t));
+    w->workers = calloc((size_t)(threads > 0 ? threads : 1), sizeof(pthread_t));
+    if (!w->queue || !w->spare || !w->workers) {
+        free(w->queue);
+        free(w->spare);
+        free(w->workers);
+        free(w);
+        return NULL;
+    }
+    pthread_mutex_init(&w->lock, NULL);
+    pthread_cond_init(&w->not_empty, NULL);
+    pthread_cond_init(&w->not_full, NULL);
+    pthread_cond_init(&w->idle, NULL);
+
+    for (i = 0; i < threads; i++) {
+        if (pthread_create(&w->workers[i], NULL, image_writer_worker, w) != 0) break;
+        w->nworkers++;
+    }
+    return w;
+}
+
+void image_writer_destroy(image_writer_t* w) {
+    int i;
+
+    if (!w) return;
+    pthread_mutex_lock(&w->lock);
+    w->shutdown = 1;
+    pthread_cond_broadcast(&w->not_empty);
+    pthread_mutex_unlock(&w->lock);
+
+    for (i = 0; i < w->nworkers; i++) {
+        pthread_join(w->workers[i], NULL);
+    }
+    for (i = 0; i < w->nspare; i++) {
+        image_free(&w->spare[i]);
+    }
+    pthread_mutex_destroy(&w->lock);
+    pthread_cond_destroy(&w->not_empty);
+    pthread_cond_destroy(&w->not_full);
+    pthread_cond_destroy(&w->idle);
+    free(w->queue);
+    free(w->spare);
+    free(w->workers);
+    free(w);
+}
@@ -0,0 +1,37 @@
+#ifndef IMAGE_WRITER_H
+#define IMAGE_WRITER_H
+#include "image.h"
+#include "image_io.h"
+
+/* ========== GRAVAÇÃO EM SEGUNDO PLANO ==========
+ *
+ * Fila limitada de quadros prontos para gravar. Quem produz entrega o
+ * buffer e segue para o próximo filtro; as threads escritoras codificam e
+ * gravam, e o buffer volta para uma lista de reaproveitamento de onde
+ * image_writer_acquire o tira de novo. Com a fila cheia, submit espera.
+ */
+
+typedef struct image_writer image_writer_t;
+
+// 'threads' escritoras (0 = grava na própria chamada de submit) e até 'depth'
+// quadros esperando na fila
+image_writer_t* image_writer_create(int threads, int depth);
+
+// Buffer de width x height x channels: um já gravado com as mesmas dimensões ou
+// um novo. O conteúdo não é zerado. 0 = sucesso, -1 = falta de memória
+int image_writer_acquire(image_writer_t* writer, image_t* img, int width, int height, int channels);
+
+// Entrega img para ser gravada em filename; a fila passa a ser dona do buffer e
+// img->data vira NULL. 0 = enfileirado (erros de gravação são informados depois)
+int image_writer_submit(image_writer_t* writer, const char* filename, image_t* img, image_format_t format);
+
+// Espera a fila esvaziar e a última gravação terminar
+void image_writer_flush(image_writer_t* writer);
+
+// Quantas gravações falharam até agora
+int image_writer_errors(image_writer_t* writer);
+
+// Espera as gravações pendentes, encerra as threads e libera os buffers
+void image_writer_destroy(image_writer_t* writer);
+
+#endif
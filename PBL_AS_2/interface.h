@@ -14,12 +14,15 @@ struct Params {
     uint32_t opcode;
     uint32_t size;
     const int8_t* c;
+    uint32_t columns;       // Colunas do lote em send_column (1 a 3)
 };
 
 /* ========== DECLARAÇÕES DE FUNÇÕES ASSEMBLY ========== */
 extern int init_hw_access(void);
 extern int close_hw_access(void);
+extern int load_kernels(const struct Params* p);
 extern int send_all_data(const struct Params* p);
+extern int send_column(const struct Params* p);
 extern int read_all_results(uint8_t* result);
 
 /* ========== KERNELS DOS FILTROS DE BORDA ========== */
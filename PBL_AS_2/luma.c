@@ -0,0 +1,62 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "luma.h"
+
+/* ========== REFERÊNCIA ESCALAR ========== */
+
+void luma_row_c(const uint8_t* rgb, uint8_t* gray, int width) {
+    int x;
+
+    for (x = 0; x < width; x++) {
+        unsigned y = LUMA_WR * rgb[0] + LUMA_WG * rgb[1] + LUMA_WB * rgb[2] + 128;
+        gray[x] = (uint8_t)(y >> 8);
+        rgb += 3;
+    }
+}
+
+static const luma_ops_t luma_ops_c = {
+    "escalar",
+    luma_row_c
+};
+
+/* ========== ESCOLHA DA IMPLEMENTAÇÃO ========== */
+
+// Mesma política do motor de convolução: a melhor versão suportada, ou a
+// indicada pela variável de ambiente LUMA_SIMD (escalar, ssse3, avx2 ou neon)
+static const luma_ops_t* luma_select_ops(void) {
+    const luma_ops_t* candidates[4];
+    const char* force = getenv("LUMA_SIMD");
+    int i, n = 0;
+
+    candidates[n++] = luma_ops_avx2();
+    candidates[n++] = luma_ops_ssse3();
+    candidates[n++] = luma_ops_neon();
+    candidates[n++] = &luma_ops_c;
+
+    for (i = 0; i < n; i++) {
+        if (!candidates[i]) continue;
+        if (!force || strcmp(force, candidates[i]->name) == 0) return candidates[i];
+    }
+    return &luma_ops_c;
+}
+
+static const luma_ops_t* luma_selected_ops = NULL;
+static pthread_once_t luma_ops_once = PTHREAD_ONCE_INIT;
+
+static void luma_ops_init(void) {
+    luma_selected_ops = luma_select_ops();
+}
+
+static const luma_ops_t* luma_ops(void) {
+    pthread_once(&luma_ops_once, luma_ops_init);
+    return luma_selected_ops;
+}
+
+luma_row_fn luma_row(void) {
+    return luma_ops()->row;
+}
+
+const char* luma_simd_name(void) {
+    return luma_ops()->name;
+}
@@ -0,0 +1,42 @@
+#ifndef LUMA_H
+#define LUMA_H
+#include <stdint.h>
+
+/* ========== CONVERSÃO RGB PARA ESCALA DE CINZA ==========
+ *
+ * Y = (77 * R + 150 * G + 29 * B + 128) >> 8
+ *
+ * Pesos BT.601 (0.299, 0.587, 0.114) em ponto fixo Q8, somando 256, com
+ * arredondamento para o mais próximo. A conta cabe em 16 bits sem sinal
+ * (máximo 65408), então as versões vetoriais dão exatamente o mesmo
+ * resultado da escalar em qualquer máquina. Em relação à antiga conta em
+ * double com truncamento, cada pixel difere no máximo em 1.
+ */
+#define LUMA_WR 77
+#define LUMA_WG 150
+#define LUMA_WB 29
+
+// Converte uma linha de 'width' pixels RGB intercalados
+typedef void (*luma_row_fn)(const uint8_t* rgb, uint8_t* gray, int width);
+
+typedef struct {
+    const char* name;
+    luma_row_fn row;
+} luma_ops_t;
+
+// Rotina de linha escolhida para esta CPU (mesma para todas as chamadas)
+luma_row_fn luma_row(void);
+
+// Nome da implementação em uso (escalar, ssse3, avx2 ou neon)
+const char* luma_simd_name(void);
+
+/* ========== IMPLEMENTAÇÕES ========== */
+
+void luma_row_c(const uint8_t* rgb, uint8_t* gray, int width);
+
+// Retornam NULL quando não foram compiladas ou a CPU não suporta as instruções
+const luma_ops_t* luma_ops_avx2(void);
+const luma_ops_t* luma_ops_ssse3(void);
+const luma_ops_t* luma_ops_neon(void);
+
+#endif
@@ -0,0 +1,51 @@
+#include <stddef.h>
+#include "luma.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#if defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/* ========== NEON: 16 PIXELS POR ITERAÇÃO ========== */
+
+// vld3 já separa os canais; vrshrn soma 128 antes do >> 8, o mesmo arredondamento da versão escalar
+static inline uint8x8_t luma_weigh8_neon(uint8x8_t r, uint8x8_t g, uint8x8_t b) {
+    uint16x8_t y = vmull_u8(r, vdup_n_u8(LUMA_WR));
+    y = vmlal_u8(y, g, vdup_n_u8(LUMA_WG));
+    y = vmlal_u8(y, b, vdup_n_u8(LUMA_WB));
+    return vrshrn_n_u16(y, 8);
+}
+
+static void luma_row_neon(const uint8_t* rgb, uint8_t* gray, int width) {
+    int x;
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        uint8x16x3_t p = vld3q_u8(rgb + 3 * x);
+        uint8x8_t lo = luma_weigh8_neon(vget_low_u8(p.val[0]), vget_low_u8(p.val[1]), vget_low_u8(p.val[2]));
+        uint8x8_t hi = luma_weigh8_neon(vget_high_u8(p.val[0]), vget_high_u8(p.val[1]), vget_high_u8(p.val[2]));
+        vst1q_u8(gray + x, vcombine_u8(lo, hi));
+    }
+    if (x < width) luma_row_c(rgb + 3 * x, gray + x, width - x);
+}
+
+static const luma_ops_t luma_ops_neon_table = {
+    "neon",
+    luma_row_neon
+};
+
+const luma_ops_t* luma_ops_neon(void) {
+#if defined(__arm__)
+    if (!(getauxval(AT_HWCAP) & HWCAP_NEON)) return NULL;
+#endif
+    return &luma_ops_neon_table;
+}
+
+#else
+
+const luma_ops_t* luma_ops_neon(void) {
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,112 @@
+#include <stddef.h>
+#include "luma.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+// Mesmo esquema de convolution_x86.c: atributo target por função e escolha em tempo de execução
+#define LUMA_SSSE3 __attribute__((target("ssse3")))
+#define LUMA_AVX2 __attribute__((target("avx2")))
+
+/* ========== SSSE3: 16 PIXELS POR ITERAÇÃO ========== */
+
+// Separa 16 pixels RGB (48 bytes) em três registradores de 16 bytes com pshufb;
+// índices -1 zeram o byte e o OR junta as três partes de cada canal
+static LUMA_SSSE3 inline void luma_deinterleave16(const uint8_t* p, __m128i* r, __m128i* g, __m128i* b) {
+    __m128i a = _mm_loadu_si128((const __m128i*)p);
+    __m128i m = _mm_loadu_si128((const __m128i*)(p + 16));
+    __m128i c = _mm_loadu_si128((const __m128i*)(p + 32));
+
+    *r = _mm_or_si128(_mm_or_si128(
+             _mm_shuffle_epi8(a, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+             _mm_shuffle_epi8(m, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1))),
+             _mm_shuffle_epi8(c, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13)));
+    *g = _mm_or_si128(_mm_or_si128(
+             _mm_shuffle_epi8(a, _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+             _mm_shuffle_epi8(m, _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1))),
+             _mm_shuffle_epi8(c, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14)));
+    *b = _mm_or_si128(_mm_or_si128(
+             _mm_shuffle_epi8(a, _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+             _mm_shuffle_epi8(m, _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1))),
+             _mm_shuffle_epi8(c, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15)));
+}
+
+// (77 r + 150 g + 29 b + 128) >> 8 em 8 pixels de 16 bits; a soma não passa de 65408
+static LUMA_SSSE3 inline __m128i luma_weigh8(__m128i r, __m128i g, __m128i b) {
+    __m128i y = _mm_mullo_epi16(r, _mm_set1_epi16(LUMA_WR));
+    y = _mm_add_epi16(y, _mm_mullo_epi16(g, _mm_set1_epi16(LUMA_WG)));
+    y = _mm_add_epi16(y, _mm_mullo_epi16(b, _mm_set1_epi16(LUMA_WB)));
+    return _mm_srli_epi16(_mm_add_epi16(y, _mm_set1_epi16(128)), 8);
+}
+
+static LUMA_SSSE3 void luma_row_ssse3(const uint8_t* rgb, uint8_t* gray, int width) {
+    __m128i zero = _mm_setzero_si128();
+    int x;
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m128i r, g, b, lo, hi;
+
+        luma_deinterleave16(rgb + 3 * x, &r, &g, &b);
+        lo = luma_weigh8(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero), _mm_unpacklo_epi8(b, zero));
+        hi = luma_weigh8(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero), _mm_unpackhi_epi8(b, zero));
+        _mm_storeu_si128((__m128i*)(gray + x), _mm_packus_epi16(lo, hi));
+    }
+    if (x < width) luma_row_c(rgb + 3 * x, gray + x, width - x);
+}
+
+static const luma_ops_t luma_ops_ssse3_table = {
+    "ssse3",
+    luma_row_ssse3
+};
+
+const luma_ops_t* luma_ops_ssse3(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("ssse3") ? &luma_ops_ssse3_table : NULL;
+}
+
+/* ========== AVX2: 32 PIXELS POR ITERAÇÃO ========== */
+
+static LUMA_AVX2 inline __m256i luma_weigh16(__m128i r, __m128i g, __m128i b) {
+    __m256i y = _mm256_mullo_epi16(_mm256_cvtepu8_epi16(r), _mm256_set1_epi16(LUMA_WR));
+    y = _mm256_add_epi16(y, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(g), _mm256_set1_epi16(LUMA_WG)));
+    y = _mm256_add_epi16(y, _mm256_mullo_epi16(_mm256_cvtepu8_epi16(b), _mm256_set1_epi16(LUMA_WB)));
+    return _mm256_srli_epi16(_mm256_add_epi16(y, _mm256_set1_epi16(128)), 8);
+}
+
+static LUMA_AVX2 void luma_row_avx2(const uint8_t* rgb, uint8_t* gray, int width) {
+    int x;
+
+    for (x = 0; x + 32 <= width; x += 32) {
+        __m128i r0, g0, b0, r1, g1, b1;
+        __m256i y;
+
+        // O pshufb de 256 bits não cruza as metades, então a separação fica em 128 bits
+        luma_deinterleave16(rgb + 3 * x, &r0, &g0, &b0);
+        luma_deinterleave16(rgb + 3 * x + 48, &r1, &g1, &b1);
+        y = _mm256_packus_epi16(luma_weigh16(r0, g0, b0), luma_weigh16(r1, g1, b1));
+        _mm256_storeu_si256((__m256i*)(gray + x), _mm256_permute4x64_epi64(y, 0xD8));
+    }
+    if (x < width) luma_row_ssse3(rgb + 3 * x, gray + x, width - x);
+}
+
+static const luma_ops_t luma_ops_avx2_table = {
+    "avx2",
+    luma_row_avx2
+};
+
+const luma_ops_t* luma_ops_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? &luma_ops_avx2_table : NULL;
+}
+
+#else
+
+const luma_ops_t* luma_ops_ssse3(void) {
+    return NULL;
+}
+
+const luma_ops_t* luma_ops_avx2(void) {
+    return NULL;
+}
+
+#endif
@@ -8,262 +8,234 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "interface.h"
+#include "hw_backend.h"
+#include "convolution.h"
+#include "thread_pool.h"
+#include "image.h"
+#include "luma.h"
+#include "resample.h"
+#include "image_io.h"
+#include "image_writer.h"
+#include "video.h"
+#include "frame_ring.h"
+#include "fpga_filter.h"
 #include <math.h>
 #include <string.h>
+#include <unistd.h>
 
 #define MATRIX_SIZE 25
-#define WIDTH 320
-#define HEIGHT 240
+// Quadros que podem esperar gravação antes de o processamento parar
+#define WRITER_DEPTH 4
 
-// Aumentar precisão - usar uint8_t para janelas e int16_t para resultados
-typedef uint8_t pixel_t;
-typedef int16_t result_t;
 // Variável global para armazenar a imagem em escala de cinza
-unsigned char grayscale[HEIGHT][WIDTH];
+image_t grayscale;
+// Pool de threads e altura das faixas do processamento em C (-t e -b na linha de comando)
+static thread_pool_t* cpu_pool = NULL;
+static int cpu_band_height = 0;
+// Tratamento das bordas da imagem nos dois caminhos (-e na linha de comando)
+static conv_border_t cpu_border = CONV_BORDER_ZERO;
+// Filtro do redimensionamento da entrada (-s na linha de comando)
+static resample_mode_t in_resample = RESAMPLE_AUTO;
+// Formato dos resultados e nível de compressão do PNG (-o e -z na linha de comando)
+static image_format_t out_format = IMAGE_FORMAT_PNG;
+static int out_png_level = IMAGE_PNG_LEVEL_DEFAULT;
+// Gravação dos resultados em segundo plano (-w na linha de comando)
+static image_writer_t* out_writer = NULL;
+// Backend do caminho da FPGA: placa (asm) ou simulador (-H na linha de comando)
+static const hw_backend_t* hw = NULL;
 static int8_t kernel_zero[MATRIX_SIZE] = {0};
-// Variável global para a janela - sempre 5x5 (25 elementos)
-pixel_t window[MATRIX_SIZE];
 
-// Função para redimensionar e carregar imagem usando STB Image
-int resize_and_load_image(const char* filename, unsigned char rgb[HEIGHT][WIDTH][3]) {
-    int img_width, img_height, channels, y, x;
-    unsigned char* input_data = stbi_load(filename, &img_width, &img_height, &channels, 3);
+// Filtros do modo "todos", na mesma ordem e com os mesmos arquivos das opções 1-5
+typedef struct {
+    const char* name;
+    const char* file;
+    int8_t* gx;
+    int8_t* gy;
+    uint32_t size_code;
+    int8_t laplaciano;
+} filter_desc_t;
+
+#define NUM_FILTERS 5
+static const filter_desc_t all_filters[NUM_FILTERS] = {
+    {"Sobel 3x3",      "1_sobel_3x3",      sobel_gx_3x3,   sobel_gy_3x3,   1, 0},
+    {"Sobel 5x5",      "2_sobel_5x5",      sobel_gx_5x5,   sobel_gy_5x5,   3, 0},
+    {"Prewitt 3x3",    "3_prewitt_3x3",    prewitt_gx_3x3, prewitt_gy_3x3, 1, 0},
+    {"Roberts 2x2",    "4_roberts_2x2",    roberts_gx_2x2, roberts_gy_2x2, 0, 0},
+    {"Laplaciano 5x5", "5_laplaciano_5x5", laplaciano_5x5, kernel_zero,    3, 1}
+};
+// JPEG guarda a luminância num canal próprio (Y); pedindo 1 canal ao stb_image
+// ele decodifica só esse plano e pula croma e conversão de cor
+static int is_jpeg_file(const char* filename) {
+    unsigned char magic[2] = {0, 0};
+    FILE* f = fopen(filename, "rb");
     
-    if (!input_data) {
+    if (!f) return 0;
+    if (fread(magic, 1, 2, f) != 2) magic[0] = 0;
+    fclose(f);
+    return magic[0] == 0xFF && magic[1] == 0xD8;
+}
+
+// Linhas decodificadas (1 ou 3 canais) levadas para escala de cinza sob demanda
+typedef struct {
+    const uint8_t* data;
+    size_t stride;
+    int channels;
+    int width;
+    luma_row_fn to_luma;
+} ingest_src_t;
+
+static const uint8_t* ingest_fetch(void* arg, int y, uint8_t* scratch) {
+    ingest_src_t* src = (ingest_src_t*)arg;
+    const uint8_t* row = src->data + y * src->stride;
+    
+    // Fonte já em cinza: o redimensionamento lê direto do buffer decodificado
+    if (src->channels == 1) return row;
+    src->to_luma(row, scratch, src->width);
+    return scratch;
+}
+
+// Carrega a imagem usando STB Image direto para escala de cinza e, se width/height > 0,
+// redimensiona para esse tamanho com in_resample; senão mantém a resolução original. Aloca gray (1 canal).
+// Decodifica com o menor número de canais que ainda dá a luminância: 1 para fontes em
+// cinza e JPEG, 3 (sem alfa) para o resto; só as linhas de origem usadas são convertidas,
+// sem cópia RGB intermediária.
+int load_grayscale_image(const char* filename, image_t* gray, int width, int height) {
+    int img_width, img_height, channels, req, y, ret;
+    unsigned char* input_data;
+    ingest_src_t src;
+    
+    if (!stbi_info(filename, &img_width, &img_height, &channels)) {
         printf("Erro ao carregar a imagem: %s\n", filename);
         return -1;
     }
+    req = (channels <= 2 || is_jpeg_file(filename)) ? 1 : 3;
+    input_data = stbi_load(filename, &img_width, &img_height, &channels, req);
     
-    printf("Imagem carregada: %dx%d pixels, %d canais\n", img_width, img_height, channels);
+    if (!input_data) {
+        printf("Erro ao carregar a imagem: %s\n", filename);
+        return -1;
+    }
     
-    // Se a imagem já tem o tamanho correto, copia diretamente
-    if (img_width == WIDTH && img_height == HEIGHT) {
-        for (y = 0; y < HEIGHT; y++) {
-            for (x = 0; x < WIDTH; x++) {
-                int idx = (y * WIDTH + x) * 3;
-                rgb[y][x][0] = input_data[idx + 0];
-                rgb[y][x][1] = input_data[idx + 1];
-                rgb[y][x][2] = input_data[idx + 2];
-            }
-        }
+    printf("Imagem carregada: %dx%d pixels, %d canais (decodificados: %d)\n", img_width, img_height, channels, req);
+    if (req == 1) {
+        printf("Escala de cinza: luminância do próprio arquivo\n");
     } else {
-        // Redimensionamento simples usando nearest neighbor
-        printf("Redimensionando de %dx%d para %dx%d\n", img_width, img_height, WIDTH, HEIGHT);
-        
-        for (y = 0; y < HEIGHT; y++) {
-            for (x = 0; x < WIDTH; x++) {
-                int src_x = (x * img_width) / WIDTH;
-                int src_y = (y * img_height) / HEIGHT;
-                
-                // Garante que não ultrapasse os limites
-                if (src_x >= img_width) src_x = img_width - 1;
-                if (src_y >= img_height) src_y = img_height - 1;
-                
-                int src_idx = (src_y * img_width + src_x) * 3;
-                rgb[y][x][0] = input_data[src_idx + 0];
-                rgb[y][x][1] = input_data[src_idx + 1];
-                rgb[y][x][2] = input_data[src_idx + 2];
-            }
-        }
+        printf("Convertendo para escala de cinza (%s)...\n", luma_simd_name());
     }
     
-    stbi_image_free(input_data);
-    return 0;
-}
-
-// Função para salvar imagem em escala de cinza como PNG
-void save_grayscale_png(const char* filename, unsigned char gray[HEIGHT][WIDTH]) {
-    if (!stbi_write_png(filename, WIDTH, HEIGHT, 1, gray, WIDTH)) {
-        printf("Erro ao salvar PNG: %s\n", filename);
-    } else {
-        printf("PNG salvo: %s\n", filename);
+    if (width <= 0 || height <= 0) {
+        width = img_width;
+        height = img_height;
     }
-}
-
-// Função de extração de janela corrigida
-void extract_window_linear(unsigned char img[HEIGHT][WIDTH], int x, int y, uint32_t size_code) {
-    int i, j, idx;
-    int px, py;
-
-    if (size_code == 0) {
-        // Caso especial para Roberts 2x2
-        for (i = 0; i < 2; i++) {
-            for (j = 0; j < 2; j++) {
-                px = x + j;
-                py = y + i;
-                
-                // Posiciona a janela 2x2 no centro da matriz 5x5
-                int row_in_5x5 = i; 
-                int col_in_5x5 = j; 
-                idx = row_in_5x5 * 5 + col_in_5x5;
-                
-                if (px >= 0 && px < WIDTH && py >= 0 && py < HEIGHT) {
-                    window[idx] = (pixel_t)img[py][px];
-                } else {
-                    window[idx] = 0; // padding para bordas
-                }
-            }
-        }
-    } else {
-        // Caso geral para janelas 3x3 e 5x5
-        int window_size;
-        switch(size_code) {
-            case 1: window_size = 3; break; // Sobel/Prewitt 3x3
-            case 3: window_size = 5; break; // Sobel 5x5/Laplaciano 5x5
-            default: window_size = 3; break;
-        }
-        
-        int half_size = window_size / 2;
-        
-        // Extrai janela centralizada
-        for (i = -half_size; i <= half_size; i++) {
-            for (j = -half_size; j <= half_size; j++) {
-                px = x + j;
-                py = y + i;
-                
-                // Calcula o índice na matriz 5x5
-                int row_in_5x5 = i + 2; 
-                int col_in_5x5 = j + 2; 
-                idx = row_in_5x5 * 5 + col_in_5x5;
-                
-                if (px >= 0 && px < WIDTH && py >= 0 && py < HEIGHT) {
-                    window[idx] = (pixel_t)img[py][px];
-                } else {
-                    window[idx] = 0; // padding para bordas
-                }
-            }
-        }
+    if (image_alloc(gray, width, height, 1) != 0) {
+        printf("Falta de memória para a imagem %dx%d\n", width, height);
+        stbi_image_free(input_data);
+        return -1;
     }
-}
-
-// Converte RGB para grayscale
-void rgb_to_grayscale(unsigned char rgb[HEIGHT][WIDTH][3], unsigned char gray[HEIGHT][WIDTH]) {
-    int y, x;
-    for (y = 0; y < HEIGHT; y++) {
-        for (x = 0; x < WIDTH; x++) {
-            unsigned char r = rgb[y][x][0];
-            unsigned char g = rgb[y][x][1];
-            unsigned char b = rgb[y][x][2];
-            gray[y][x] = (unsigned char)(0.299*r + 0.587*g + 0.114*b);
+    src.data = input_data;
+    src.stride = (size_t)img_width * req;
+    src.channels = req;
+    src.width = img_width;
+    src.to_luma = luma_row();
+    
+    // Se a imagem já tem o tamanho correto, converte linha a linha direto no destino
+    if (img_width == width && img_height == height) {
+        for (y = 0; y < height; y++) {
+            uint8_t* dst = image_row(gray, y);
+            const uint8_t* row = ingest_fetch(&src, y, dst);
+            
+            if (row != dst) memcpy(dst, row, (size_t)width);
         }
+        stbi_image_free(input_data);
+        return 0;
     }
+    
+    // Redimensiona em ponto fixo sobre as linhas de origem já em cinza (resample.h)
+    printf("Redimensionando de %dx%d para %dx%d (%s/%s, %s)\n", img_width, img_height, width, height,
+           resample_mode_name(resample_axis_mode(in_resample, img_width, width)),
+           resample_mode_name(resample_axis_mode(in_resample, img_height, height)), resample_simd_name());
+    ret = resample_rows(in_resample, ingest_fetch, &src, img_width, img_height, gray->data, gray->stride, width, height);
+    stbi_image_free(input_data);
+    if (ret != 0) {
+        printf("Falta de memória para a imagem %dx%d\n", width, height);
+        image_free(gray);
+        return -1;
+    }
+    return 0;
 }
 
-// Função simples de saturação - clamp para faixa 0-255
-unsigned char saturate_pixel(result_t value) {
-    if (value < 0) return 0;
-    if (value > 255) return 255;
-    return (unsigned char)value;
+// Entrega a imagem em escala de cinza ao escritor em segundo plano, no formato de
+// saída escolhido; name vem sem extensão e recebe a do formato (.png, .pgm ou .raw).
+// O buffer passa a ser do escritor (gray->data vira NULL) e volta por image_writer_acquire.
+void save_grayscale(const char* name, image_t* gray) {
+    char filename[128];
+    
+    snprintf(filename, sizeof(filename), "%s.%s", name, image_format_ext(out_format));
+    image_writer_submit(out_writer, filename, gray, out_format);
 }
 
-// Função de convolução em C (versão de referência)
-int compute_convolution_cpu(pixel_t* image_window, int8_t* filter_kernel_gx, int8_t* filter_kernel_gy, int8_t laplaciano) {
-    result_t gx = 0, gy = 0;
-    int i;
+// Função para aplicar filtro usando processamento em C (0 = sucesso, -1 = falta de memória)
+int operation_filter_cpu(const image_t* src, int8_t* filter_gx, int8_t* filter_gy, uint32_t size_code, image_t* result, int8_t laplaciano) {
+    conv_kernel_t kernel;
     
-    if (laplaciano == 1) {
-        // Para Laplaciano, usa apenas o primeiro kernel
-        for (i = 0; i < MATRIX_SIZE; i++) {
-            gx += (result_t)image_window[i] * (result_t)filter_kernel_gx[i];
-        }
-        return saturate_pixel(gx);
-    } else {
-        // Para filtros de gradiente (Sobel, Prewitt, Roberts)
-        for (i = 0; i < MATRIX_SIZE; i++) {
-            gx += (result_t)image_window[i] * (result_t)filter_kernel_gx[i];
-            gy += (result_t)image_window[i] * (result_t)filter_kernel_gy[i];
-        }
-        
-        // Calcula a magnitude do gradiente
-        double magnitude = sqrt((double)(gx * gx + gy * gy));
-        return saturate_pixel((result_t)magnitude);
+    conv_kernel_init(&kernel, filter_gx, filter_gy, size_code, laplaciano);
+    kernel.border = cpu_border;
+    if (conv_filter_bands(&kernel, src->data, src->width, src->height, src->stride, result->data, result->stride, cpu_pool, cpu_band_height) != 0) {
+        fprintf(stderr, "Falta de memória para o filtro (CPU)\n");
+        return -1;
     }
+    
+    printf("Filtro aplicado com sucesso (CPU)!\n");
+    return 0;
 }
 
-// Função para aplicar filtro usando processamento em C
-void operation_filter_cpu(int8_t* filter_gx, int8_t* filter_gy, uint32_t size_code, unsigned char result[HEIGHT][WIDTH], int8_t laplaciano) {
-    int x, y;
+// Aplica os cinco filtros numa única varredura da imagem (CPU).
+// Todos os planos de resultado têm o mesmo stride. 0 = sucesso, -1 = falta de memória
+int operation_filter_all_cpu(const image_t* src, image_t result[NUM_FILTERS]) {
+    conv_kernel_t kernels[NUM_FILTERS];
+    uint8_t* planes[NUM_FILTERS];
+    int i;
     
-    for (y = 0; y < HEIGHT; y++) {        
-        for (x = 0; x < WIDTH; x++) {
-            extract_window_linear(grayscale, x, y, size_code);
-            result[y][x] = compute_convolution_cpu(window, filter_gx, filter_gy, laplaciano);
-        }
+    for (i = 0; i < NUM_FILTERS; i++) {
+        const filter_desc_t* f = &all_filters[i];
+        conv_kernel_init(&kernels[i], f->gx, f->gy, f->size_code, f->laplaciano);
+        kernels[i].border = cpu_border;
+        planes[i] = result[i].data;
+    }
+    if (conv_filter_multi_bands(kernels, NUM_FILTERS, src->data, src->width, src->height, src->stride, planes, result[0].stride, cpu_pool, cpu_band_height) != 0) {
+        fprintf(stderr, "Falta de memória para os filtros (CPU)\n");
+        return -1;
     }
     
-    printf("Filtro aplicado com sucesso (CPU)!\n");
+    printf("Filtros aplicados com sucesso (CPU, passada única)!\n");
+    return 0;
 }
 
-int compute_convolution(pixel_t* image_window, int8_t* filter_kernel_gx, int8_t* filter_kernel_gy, int8_t laplaciano) {
-    pixel_t result[MATRIX_SIZE];
-    pixel_t result_final = 0;
-    
-    if (laplaciano == 1) {
-        struct Params params = {
-            .a = image_window,
-            .b = filter_kernel_gx,
-            .opcode = 6,
-            .size = 3,
-            .c = filter_kernel_gy
-        };
-        
-        if (send_all_data(&params) != HW_SUCCESS) {
-            fprintf(stderr, "Falha no envio de dados para a FPGA\n");
-            return 0;
-        }
-        
-        if (read_all_results(result) != HW_SUCCESS) {
-            fprintf(stderr, "Falha na leitura dos resultados da FPGA\n");
-            return 0;
-        }
-        
-        // Combina os bytes do resultado
-        result_t result_temp = (int16_t)((result[1] << 8) | result[0]);
-        result_t abs_result = abs(result_temp);
-        
-        return saturate_pixel(abs_result);
-
-    } else {
-        struct Params params = {
-            .a = image_window,
-            .b = filter_kernel_gx,
-            .opcode = 7,
-            .size = 3,
-            .c = filter_kernel_gy
-        };
-        
-        if (send_all_data(&params) != HW_SUCCESS) {
-            fprintf(stderr, "Falha no envio de dados para a FPGA\n");
-            return 0;
-        }
-        
-        if (read_all_results(result) != HW_SUCCESS) {
-            fprintf(stderr, "Falha na leitura dos resultados da FPGA\n");
-            return 0;
-        }
-        result_final = result[0];
-        return result_final;
-    }
+// Calcula a imagem com o filtro de borda selecionado (0 = sucesso, -1 = falha)
+int operation_filter(const image_t* src, int8_t* filter_gx, int8_t* filter_gy, uint32_t size_code, image_t* result, int8_t laplaciano) {
+    if (fpga_filter_pass(hw, src, filter_gx, filter_gy, size_code, laplaciano, cpu_border, result) != 0) return -1;
+    printf("Filtro de gradiente aplicado com sucesso!\n");
+    if (hw->report) hw->report("FPGA");
+    return 0;
 }
 
-// Calcula a imagem com o filtro de borda selecionado
-void operation_filter(int8_t* filter_gx, int8_t* filter_gy, uint32_t size_code, unsigned char result[HEIGHT][WIDTH], int8_t laplaciano) {
-    int x, y;
-    
-    for (y = 0; y < HEIGHT; y++) {
-        if (y % 40 == 0) printf("Processando linha %d/%d\n", y, HEIGHT);
-        
-        for (x = 0; x < WIDTH; x++) {
-            extract_window_linear(grayscale, x, y, size_code);
-            result[y][x] = compute_convolution(window, filter_gx, filter_gy, laplaciano);
-        }
+// Aplica os cinco filtros na FPGA um de cada vez: trocar de kernels a cada
+// janela custaria tanto quanto os reenviar junto com os pixels. 0 = sucesso;
+// -1 = falha em algum filtro, e os planos seguintes ficam sem calcular
+int operation_filter_all(const image_t* src, image_t result[NUM_FILTERS]) {
+    int i;
     
+    for (i = 0; i < NUM_FILTERS; i++) {
+        const filter_desc_t* f = &all_filters[i];
+        if (fpga_filter_pass(hw, src, f->gx, f->gy, f->size_code, f->laplaciano, cpu_border, &result[i]) != 0) return -1;
     }
-    printf("Filtro de gradiente aplicado com sucesso!\n");
+    printf("Filtros aplicados com sucesso (FPGA)!\n");
+    if (hw->report) hw->report("FPGA");
+    return 0;
 }
 
 int validate_operation(uint32_t selection) {
-    if (selection < 1 || selection > 6) {
+    if (selection < 1 || selection > 7) {
         fprintf(stderr, "Opção inválida: %u\n", selection);
         return HW_SEND_FAIL;
     }
@@ -276,10 +248,12 @@ typedef struct {
     double max_percentage_difference;      // Maior diferença percentual encontrada
     double min_percentage_difference;      // Menor diferença percentual encontrada
     int pixels_with_zero_reference;        // Pixels onde referência = 0 (divisão por zero)
+    int pixels_different;                  // Pixels diferentes byte a byte (inclui referência = 0)
     int total_valid_pixels;               // Total de pixels válidos para comparação
+    int total_pixels;                     // Total de pixels da imagem
 } PercentageDifference;
 
-PercentageDifference calculate_percentage_difference(unsigned char reference[HEIGHT][WIDTH], unsigned char generated[HEIGHT][WIDTH]) {
+PercentageDifference calculate_percentage_difference(const image_t* reference, const image_t* generated) {
     PercentageDifference result = {0};
     double sum_percentage = 0.0;
     int x, y;
@@ -289,11 +263,16 @@ PercentageDifference calculate_percentage_difference(unsigned char reference[HEI
     result.max_percentage_difference = 0.0;
     result.min_percentage_difference = 100.0;
     
-    for (y = 0; y < HEIGHT; y++) {
-        for (x = 0; x < WIDTH; x++) {
-            unsigned char ref_pixel = reference[y][x];
-            unsigned char gen_pixel = generated[y][x];
+    result.total_pixels = reference->width * reference->height;
+    
+    for (y = 0; y < reference->height; y++) {
+        const uint8_t* ref_row = image_row(reference, y);
+        const uint8_t* gen_row = image_row(generated, y);
+        for (x = 0; x < reference->width; x++) {
+            unsigned char ref_pixel = ref_row[x];
+            unsigned char gen_pixel = gen_row[x];
             
+            if (ref_pixel != gen_pixel) result.pixels_different++;
             if (ref_pixel == 0) {
                 // Pixel de referência é zero - não podemos dividir
                 result.pixels_with_zero_reference++;
@@ -330,16 +309,20 @@ PercentageDifference calculate_percentage_difference(unsigned char reference[HEI
 // Função para imprimir o relatório simplificado
 void print_percentage_report(PercentageDifference diff, const char* filter_name) {
     printf("\n========= DIFERENÇA PERCENTUAL - %s =========\n", filter_name);
-    printf("Total de pixels: %d\n", HEIGHT * WIDTH);
+    printf("Total de pixels: %d\n", diff.total_pixels);
     printf("Pixels válidos para comparação: %d\n", diff.total_valid_pixels);
     printf("Pixels com referência = 0: %d\n", diff.pixels_with_zero_reference);
+    printf("Pixels diferentes (byte a byte): %d\n", diff.pixels_different);
     printf("\nDIFERENÇA PERCENTUAL:\n");
     printf("  Média: %.2f%%\n", diff.average_percentage_difference);
     printf("  Máxima: %.2f%%\n", diff.max_percentage_difference);
     printf("  Mínima: %.2f%%\n", diff.min_percentage_difference);
     
-    // Interpretação
-    if (diff.average_percentage_difference < 1.0) {
+    // Interpretação: a média ignora os pixels com referência = 0, então só a
+    // contagem byte a byte garante que as saídas são idênticas
+    if (diff.pixels_different == 0) {
+        printf("✓ RESULTADO: Saídas idênticas\n");
+    } else if (diff.average_percentage_difference < 1.0) {
         printf("✓ RESULTADO: Excelente precisão (< 1%% diferença)\n");
     } else if (diff.average_percentage_difference < 5.0) {
         printf("✓ RESULTADO: Boa precisão (< 5%% diferença)\n");
@@ -352,40 +335,412 @@ void print_percentage_report(PercentageDifference diff, const char* filter_name)
 }
 
 
-int main() {
+/* ========== MODO EM FAIXAS ========== */
+
+// Entrada e saídas do modo -i: lidas e gravadas em sequência, faixa por faixa
+typedef struct {
+    image_stream_t in;
+    image_stream_t out[NUM_FILTERS];
+} stream_files_t;
+
+static int stream_read(void* arg, uint8_t* dst, int stride, int rows) {
+    stream_files_t* files = (stream_files_t*)arg;
+    return image_stream_read_rows(&files->in, dst, stride, rows);
+}
+
+static int stream_write(void* arg, int index, const uint8_t* rows, int stride, int y0, int nrows) {
+    stream_files_t* files = (stream_files_t*)arg;
+    (void)y0;
+    return image_stream_write_rows(&files->out[index], rows, stride, nrows);
+}
+
+// Aplica o filtro escolhido (1-5, ou 6 para todos) num PGM/raw de qualquer tamanho
+// sem carregá-lo inteiro: em memória ficam só a faixa de entrada com o halo e uma
+// faixa de saída por filtro. Só o caminho em C; os resultados saem em PGM ou raw.
+int stream_filter_file(const char* filename, int raw_width, int raw_height, uint32_t selection) {
+    stream_files_t files;
+    conv_kernel_t kernels[NUM_FILTERS];
+    image_format_t format = (out_format == IMAGE_FORMAT_RAW) ? IMAGE_FORMAT_RAW : IMAGE_FORMAT_PGM;
+    int first = (selection == 6) ? 0 : (int)selection - 1;
+    int count = (selection == 6) ? NUM_FILTERS : 1;
+    char names[NUM_FILTERS][128];
+    int opened = 0, status = -1, i;
+    
+    if (image_stream_open_read(&files.in, filename, raw_width, raw_height) != 0) {
+        printf("Erro ao abrir %s (PGM P5 de 8 bits, ou raw com -g LxA)\n", filename);
+        return -1;
+    }
+    printf("Modo em faixas: %s, %dx%d pixels, faixas de %d linhas\n", filename, files.in.width, files.in.height,
+           conv_stream_strip_auto(thread_pool_size(cpu_pool)));
+    
+    for (i = 0; i < count; i++) {
+        const filter_desc_t* f = &all_filters[first + i];
+        
+        conv_kernel_init(&kernels[i], f->gx, f->gy, f->size_code, f->laplaciano);
+        kernels[i].border = cpu_border;
+        snprintf(names[i], sizeof(names[i]), "%s_cpu.%s", f->file, image_format_ext(format));
+        if (image_stream_open_write(&files.out[i], names[i], format, files.in.width, files.in.height) != 0) {
+            printf("Erro ao criar %s\n", names[i]);
+            goto done;
+        }
+        opened++;
+    }
+    
+    status = conv_filter_multi_stream(kernels, count, files.in.width, files.in.height, stream_read, stream_write,
+                                      &files, cpu_pool, 0, cpu_band_height);
+    if (status != 0) printf("Erro de leitura, gravação ou memória no modo em faixas\n");
+    
+done:
+    for (i = 0; i < opened; i++) {
+        if (image_stream_close(&files.out[i]) != 0) status = -1;
+        else if (status == 0) printf("Imagem salva: %s\n", names[i]);
+    }
+    image_stream_close(&files.in);
+    return status;
+}
+
+/* ========== MODO DE VÍDEO ========== */
+
+static int video_process(void* arg, const image_t* in, image_t* out) {
+    const conv_kernel_t* k = (const conv_kernel_t*)arg;
+    return conv_filter_bands(k, in->data, in->width, in->height, in->stride, out->data, out->stride, cpu_pool, cpu_band_height);
+}
+
+// Aplica um filtro (1-5) a cada quadro de uma sequência Y4M ou raw, lendo,
+// filtrando e gravando em paralelo (video.h). Só o caminho em C. Como a saída
+// pode ser a saída padrão, as mensagens vão para stderr.
+int video_filter_sequence(const char* input, const char* output, int raw_width, int raw_height, uint32_t selection) {
+    const filter_desc_t* f = &all_filters[selection - 1];
+    conv_kernel_t kernel;
+    video_in_t in;
+    video_out_t out;
+    video_stats_t stats;
+    int status;
+    
+    if (video_open_read(&in, input, raw_width, raw_height) != 0) {
+        fprintf(stderr, "Erro ao abrir %s (Y4M de 8 bits, ou raw com -g LxA)\n", input);
+        return -1;
+    }
+    // Saída Y4M monocromática, ou quadros raw com -o raw
+    if (video_open_write(&out, output, out_format != IMAGE_FORMAT_RAW, in.width, in.height, in.fps_num, in.fps_den) != 0) {
+        fprintf(stderr, "Erro ao criar %s\n", output);
+        video_close_read(&in);
+        return -1;
+    }
+    fprintf(stderr, "Modo de vídeo: %s, %dx%d, %s, entrada %s\n", input, in.width, in.height, f->name,
+            in.live ? "ao vivo (descarta quadros atrasados)" : "arquivo");
+    
+    conv_kernel_init(&kernel, f->gx, f->gy, f->size_code, f->laplaciano);
+    kernel.border = cpu_border;
+    status = video_run(&in, &out, video_process, &kernel, &stats);
+    if (video_close_write(&out) != 0) status = -1;
+    video_close_read(&in);
+    
+    fprintf(stderr, "Lidos: %ld, descartados: %ld, gravados: %ld em %.2f s (%.1f fps)\n",
+            stats.frames_read, stats.frames_dropped, stats.frames_written, stats.seconds, stats.fps);
+    if (status != 0) fprintf(stderr, "Erro de leitura, gravação ou memória no modo de vídeo\n");
+    return status;
+}
+
+/* ========== MODO DE MEMÓRIA COMPARTILHADA ========== */
+
+// Filtra os quadros do anel de entrada direto na memória compartilhada e publica
+// os resultados no anel de saída (criado aqui, com a geometria da entrada), sem
+// arquivos e sem cópias. Sem anel de saída os resultados vão para um buffer
+// local (só mede). Roda até o produtor fechar o anel de entrada.
+int ring_filter_sequence(const char* input, const char* output, uint32_t selection) {
+    const filter_desc_t* f = &all_filters[selection - 1];
+    conv_kernel_t kernel;
+    frame_ring_t in, out;
+    frame_ring_frame_t src, dst;
+    image_t scratch = { 0 };
+    uint64_t start = 0, last = 0, latency = 0, now;
+    long frames = 0;
+    int status = 0;
+    
+    if (frame_ring_open(&in, input) != 0) {
+        printf("Erro ao abrir o anel %s (o produtor precisa criá-lo antes)\n", input);
+        return -1;
+    }
+    if (output) {
+        if (frame_ring_create(&out, output, in.width, in.height, in.slots) != 0) {
+            printf("Erro ao criar o anel %s\n", output);
+            frame_ring_unmap(&in);
+            return -1;
+        }
+    } else if (image_alloc(&scratch, in.width, in.height, 1) != 0) {
+        printf("Falta de memória para o quadro de saída\n");
+        frame_ring_unmap(&in);
+        return -1;
+    }
+    printf("Modo de memória compartilhada: %s -> %s, %dx%d, %d quadros por anel, %s\n", input,
+           output ? output : "(descartado)", in.width, in.height, in.slots, f->name);
+    
+    conv_kernel_init(&kernel, f->gx, f->gy, f->size_code, f->laplaciano);
+    kernel.border = cpu_border;
+    while (frame_ring_begin_read(&in, &src) == 0) {
+        // Com wait = 1 o anel só devolve quadro; checa mesmo assim, como na leitura
+        if (output) {
+            if (frame_ring_begin_write(&out, &dst, 1) != 0) {
+                printf("Anel de saída %s sem quadro livre\n", output);
+                status = -1;
+                break;
+            }
+        } else dst.img = scratch;
+        
+        if (conv_filter_bands(&kernel, src.img.data, in.width, in.height, src.img.stride,
+                              dst.img.data, dst.img.stride, cpu_pool, cpu_band_height) != 0) {
+            printf("Falta de memória no modo de memória compartilhada\n");
+            status = -1;
+            break;
+        }
+        if (output) {
+            dst.sequence = src.sequence;
+            dst.timestamp_ns = src.timestamp_ns;
+            frame_ring_end_write(&out, &dst);
+        }
+        frame_ring_end_read(&in);
+        
+        now = frame_ring_now_ns();
+        if (frames++ == 0) start = last = now;
+        latency += now - src.timestamp_ns;
+        if (now - last >= 1000000000u) {
+            printf("quadros: %ld filtrados, %.1f fps\n", frames, (frames - 1) / ((now - start) / 1e9));
+            last = now;
+        }
+    }
+    
+    now = frame_ring_now_ns();
+    printf("Total: %ld quadros, %.1f fps, latência média %.2f ms (desde a publicação na entrada)\n", frames,
+           (frames > 1) ? (frames - 1) / ((now - start) / 1e9) : 0.0, frames ? latency / 1e6 / frames : 0.0);
+    if (output) {
+        // Quem já abriu o anel de saída continua lendo o que falta depois do unlink
+        frame_ring_close(&out);
+        frame_ring_unmap(&out);
+        frame_ring_unlink(output);
+    }
+    image_free(&scratch);
+    frame_ring_unmap(&in);
+    return status;
+}
+
+void print_usage(const char* program) {
+    printf("Uso: %s [-t threads] [-b linhas_por_faixa] [-e borda] [-r LxA] [-s filtro] [-o formato] [-z nível] [-w escritores] [-H backend]\n", program);
+    printf("       %s -i entrada.pgm [-g LxA] [-f filtro] [-t threads] [-b linhas] [-e borda] [-o formato]\n", program);
+    printf("       %s -m /anel_entrada [-M /anel_saída] [-f filtro] [-t threads] [-b linhas] [-e borda]\n", program);
+    printf("       %s -v entrada.y4m [-V saída.y4m] [-g LxA] [-f filtro] [-t threads] [-b linhas] [-e borda] [-o raw]\n", program);
+    printf("  -t  threads do processamento em C (padrão: número de núcleos)\n");
+    printf("  -b  altura das faixas de linhas (padrão: automática)\n");
+    printf("  -e  tratamento das bordas: zero, replicate, reflect ou skip (padrão: zero)\n");
+    printf("  -r  redimensiona a entrada para L x A pixels (padrão: resolução original)\n");
+    printf("  -s  filtro do redimensionamento: auto, area, bilinear ou nearest (padrão: auto,\n");
+    printf("      média de área ao reduzir e bilinear ao ampliar)\n");
+    printf("  -o  formato dos resultados: png, pgm ou raw (padrão: png)\n");
+    printf("  -z  nível de compressão do PNG, 0 a 9, maior = menor e mais lento (padrão: %d)\n", IMAGE_PNG_LEVEL_DEFAULT);
+    printf("  -w  threads que gravam os resultados em segundo plano, 0 = grava na hora (padrão: 1)\n");
+    printf("  -H  caminho da FPGA: asm (placa, só no ARM) ou sim (simulador do ControlUnit)\n");
+    printf("      (padrão: variável HW_BACKEND, senão asm quando disponível, senão sim)\n");
+    printf("  -i  modo em faixas: filtra um PGM (ou raw) de qualquer tamanho sem carregá-lo inteiro\n");
+    printf("  -v  modo de vídeo: filtra cada quadro de um Y4M ou raw (\"-\" = entrada padrão)\n");
+    printf("  -V  saída do modo -v, Y4M ou raw com -o raw (\"-\" = saída padrão; padrão: só mede)\n");
+    printf("  -m  modo de memória compartilhada: filtra os quadros do anel POSIX criado por outro processo\n");
+    printf("  -M  anel de saída do modo -m, criado com a geometria da entrada (padrão: só mede)\n");
+    printf("  -g  dimensões L x A da entrada raw dos modos -i e -v\n");
+    printf("  -f  filtro dos modos -i, -v e -m: 1 a 5 como no menu, 6 = todos, só no -i (padrão: 6 no -i, 1 nos outros)\n");
+}
+
+int main(int argc, char* argv[]) {
     char output[100];
     char jpg_output[100];
-    unsigned char rgb[HEIGHT][WIDTH][3];
-    unsigned char filter_result[HEIGHT][WIDTH];
+    image_t filter_result;
+    image_t gray_copy;
     uint32_t selection;
-    int y, x;
-
-    unsigned char filter_result_cpu[HEIGHT][WIDTH];  // Resultado do processamento em C (referência)
+    int i;
+    
+    image_t filter_result_cpu;  // Resultado do processamento em C (referência)
+    image_t all_result[NUM_FILTERS];
+    image_t all_result_cpu[NUM_FILTERS];
+    int in_width = 0, in_height = 0;
     PercentageDifference percentage_diff;
     char cpu_output[100];
     char diff_output[100];
+    int threads = 0;
+    int writers = 1;
+    const char* stream_input = NULL;
+    int raw_width = 0, raw_height = 0;
+    uint32_t stream_selection = 0;
+    const char* video_input = NULL;
+    const char* video_output = NULL;
+    thread_pool_t* png_pool = NULL;
+    const char* ring_input = NULL;
+    const char* ring_output = NULL;
+    int status;
+    int opt;
+    
+    while ((opt = getopt(argc, argv, "t:b:e:r:s:o:z:w:i:g:f:v:V:m:M:H:h")) != -1) {
+        switch (opt) {
+            case 't': threads = atoi(optarg); break;
+            case 'b': cpu_band_height = atoi(optarg); break;
+            case 'e':
+                if (conv_border_parse(optarg, &cpu_border) != 0) {
+                    fprintf(stderr, "Modo de borda inválido: %s\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'r':
+                if (sscanf(optarg, "%dx%d", &in_width, &in_height) != 2 || in_width <= 0 || in_height <= 0) {
+                    fprintf(stderr, "Tamanho inválido: %s\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 's':
+                if (resample_mode_parse(optarg, &in_resample) != 0) {
+                    fprintf(stderr, "Filtro de redimensionamento inválido: %s\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'o':
+                if (image_format_parse(optarg, &out_format) != 0) {
+                    fprintf(stderr, "Formato de saída inválido: %s\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'w': writers = atoi(optarg); break;
+            case 'i': stream_input = optarg; break;
+            case 'v': video_input = optarg; break;
+            case 'V': video_output = optarg; break;
+            case 'm': ring_input = optarg; break;
+            case 'M': ring_output = optarg; break;
+            case 'H':
+                hw = hw_backend_find(optarg);
+                if (!hw) {
+                    fprintf(stderr, "Backend indisponível: %s\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'g':
+                if (sscanf(optarg, "%dx%d", &raw_width, &raw_height) != 2 || raw_width <= 0 || raw_height <= 0) {
+                    fprintf(stderr, "Tamanho inválido: %s\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'f':
+                stream_selection = (uint32_t)atoi(optarg);
+                if (stream_selection < 1 || stream_selection > 6) {
+                    fprintf(stderr, "Filtro inválido: %s\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'z':
+                out_png_level = atoi(optarg);
+                if (out_png_level < 0 || out_png_level > 9) {
+                    fprintf(stderr, "Nível de compressão inválido: %s\n", optarg);
+                    print_usage(argv[0]);
+                    return EXIT_FAILURE;
+                }
+                break;
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+    
+    // Modo de memória compartilhada: processa até o produtor fechar o anel e sai
+    if (ring_input) {
+        if (stream_selection == 6) {
+            fprintf(stderr, "O modo de memória compartilhada aplica um filtro só (-f 1 a 5)\n");
+            return EXIT_FAILURE;
+        }
+        cpu_pool = thread_pool_create(threads);
+        if (!cpu_pool) {
+            fprintf(stderr, "Falha ao criar o pool de threads\n");
+            return EXIT_FAILURE;
+        }
+        printf("Motor de convolução (CPU): %s, %d thread(s), bordas: %s\n", conv_simd_name(), thread_pool_size(cpu_pool), conv_border_name(cpu_border));
+        status = ring_filter_sequence(ring_input, ring_output, stream_selection ? stream_selection : 1);
+        thread_pool_destroy(cpu_pool);
+        return (status == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
     
-    // Inicializa buffer de resultado
-    for (y = 0; y < HEIGHT; y++) {
-        for (x = 0; x < WIDTH; x++) {
-            filter_result[y][x] = 0;
+    // Modo de vídeo: processa a sequência e sai, sem menu e sem a FPGA
+    if (video_input) {
+        if (stream_selection == 6) {
+            fprintf(stderr, "O modo de vídeo aplica um filtro só (-f 1 a 5)\n");
+            return EXIT_FAILURE;
         }
+        cpu_pool = thread_pool_create(threads);
+        if (!cpu_pool) {
+            fprintf(stderr, "Falha ao criar o pool de threads\n");
+            return EXIT_FAILURE;
+        }
+        fprintf(stderr, "Motor de convolução (CPU): %s, %d thread(s), bordas: %s\n", conv_simd_name(), thread_pool_size(cpu_pool), conv_border_name(cpu_border));
+        status = video_filter_sequence(video_input, video_output, raw_width, raw_height, stream_selection ? stream_selection : 1);
+        thread_pool_destroy(cpu_pool);
+        return (status == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    
+    // Modo em faixas: processa o arquivo e sai, sem menu e sem a FPGA
+    if (stream_input) {
+        cpu_pool = thread_pool_create(threads);
+        if (!cpu_pool) {
+            fprintf(stderr, "Falha ao criar o pool de threads\n");
+            return EXIT_FAILURE;
+        }
+        printf("Motor de convolução (CPU): %s, %d thread(s), bordas: %s\n", conv_simd_name(), thread_pool_size(cpu_pool), conv_border_name(cpu_border));
+        status = stream_filter_file(stream_input, raw_width, raw_height, stream_selection ? stream_selection : 6);
+        thread_pool_destroy(cpu_pool);
+        return (status == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
     }
     
     // Carrega apenas a imagem.png
     printf("Carregando imagem.png...\n");
-    if (resize_and_load_image("imagem.png", rgb) != 0) {
+    if (load_grayscale_image("imagem.png", &grayscale, in_width, in_height) != 0) {
         fprintf(stderr, "Não foi possível carregar imagem.png!\n");
         return EXIT_FAILURE;
     }
     
-    printf("Convertendo para escala de cinza...\n");
-    rgb_to_grayscale(rgb, grayscale);
-    save_grayscale_png("imagem_cinza.png", grayscale);
+    // Até WRITER_DEPTH quadros esperam na fila; acima disso quem produz espera.
+    // Nível e pool do PNG são globais: fixados antes de as escritoras existirem.
+    // O pool do PNG é separado do da convolução, que filtra enquanto as escritoras gravam
+    image_png_set_level(out_png_level);
+    if (out_format == IMAGE_FORMAT_PNG) {
+        png_pool = thread_pool_create(threads);
+        if (!png_pool)
+            fprintf(stderr, "Falha ao criar o pool do PNG; compressão serial\n");
+        image_png_set_pool(png_pool);
+    }
+    out_writer = image_writer_create(writers, WRITER_DEPTH);
+    if (!out_writer) {
+        fprintf(stderr, "Falha ao criar o escritor de imagens\n");
+        return EXIT_FAILURE;
+    }
+    
+    // O escritor fica com uma cópia: grayscale segue como entrada dos filtros
+    if (image_writer_acquire(out_writer, &gray_copy, grayscale.width, grayscale.height, 1) != 0) {
+        fprintf(stderr, "Falta de memória para as imagens\n");
+        return EXIT_FAILURE;
+    }
+    memcpy(gray_copy.data, grayscale.data, (size_t)grayscale.stride * grayscale.height);
+    save_grayscale("imagem_cinza", &gray_copy);
+
+    cpu_pool = thread_pool_create(threads);
+    if (!cpu_pool) {
+        fprintf(stderr, "Falha ao criar o pool de threads\n");
+        return EXIT_FAILURE;
+    }
+    printf("Motor de convolução (CPU): %s, %d thread(s), bordas: %s\n", conv_simd_name(), thread_pool_size(cpu_pool), conv_border_name(cpu_border));
     
     // Inicializa o hardware
-    printf("Inicializando hardware...\n");
-    if (init_hw_access() != HW_SUCCESS) { 
+    if (!hw) hw = hw_backend_default();
+    printf("Inicializando hardware (backend: %s)...\n", hw->name);
+    if (hw->init() != HW_SUCCESS) { 
         fprintf(stderr, "Falha na inicialização do hardware\n");
         return EXIT_FAILURE;
     }
@@ -400,7 +755,8 @@ int main() {
         printf("3 - Prewitt (3x3)\n");
         printf("4 - Roberts (2x2)\n");
         printf("5 - Laplaciano (5x5)\n");
-        printf("6 - Sair\n");
+        printf("6 - Todos os filtros (passada única)\n");
+        printf("7 - Sair\n");
         printf("Opção: ");
         
         if (scanf("%u", &selection) != 1) {
@@ -409,7 +765,7 @@ int main() {
             continue;
         }
         
-        if (selection == 6) {
+        if (selection == 7) {
             printf("Encerrando programa...\n");
             break;
         }
@@ -418,6 +774,15 @@ int main() {
             continue;
         }
         
+        // Os planos de saída vêm do escritor: buffers já gravados são reaproveitados
+        if (selection <= 5 &&
+            (image_writer_acquire(out_writer, &filter_result_cpu, grayscale.width, grayscale.height, 1) != 0 ||
+             image_writer_acquire(out_writer, &filter_result, grayscale.width, grayscale.height, 1) != 0)) {
+            fprintf(stderr, "Falta de memória para os planos de saída\n");
+            image_free(&filter_result_cpu);
+            continue;
+        }
+        
         // Aplica o filtro selecionado
         switch (selection) {
             case 1:
@@ -425,21 +790,28 @@ int main() {
                 
                 // Processa com CPU (referência)
                 printf("Processando com CPU (referência)...\n");
-                operation_filter_cpu(sobel_gx_3x3, sobel_gy_3x3, 1, filter_result_cpu, 0);
-                sprintf(cpu_output, "1_sobel_3x3_cpu.png");
+                status = operation_filter_cpu(&grayscale, sobel_gx_3x3, sobel_gy_3x3, 1, &filter_result_cpu, 0);
+                sprintf(cpu_output, "1_sobel_3x3_cpu");
                 
                 // Processa com FPGA
                 printf("Processando com FPGA...\n");
-                operation_filter(sobel_gx_3x3, sobel_gy_3x3, 1, filter_result, 0);
-                sprintf(output, "1_sobel_3x3_fpga.png");
+                if (status == 0) status = operation_filter(&grayscale, sobel_gx_3x3, sobel_gy_3x3, 1, &filter_result, 0);
+                sprintf(output, "1_sobel_3x3_fpga");
+                
+                // Com falha, os planos reaproveitados têm dados de outro filtro
+                if (status != 0) {
+                    image_free(&filter_result_cpu);
+                    image_free(&filter_result);
+                    break;
+                }
                 
                 // Calcula porcentagem de diferença (CPU como referência)
-                percentage_diff = calculate_percentage_difference(filter_result_cpu, filter_result);
+                percentage_diff = calculate_percentage_difference(&filter_result_cpu, &filter_result);
                 print_percentage_report(percentage_diff, "Sobel 3x3");
                 
                 // Salva imagens
-                save_grayscale_png(cpu_output, filter_result_cpu);
-                save_grayscale_png(output, filter_result);
+                save_grayscale(cpu_output, &filter_result_cpu);
+                save_grayscale(output, &filter_result);
                 break;
                 
             case 2:
@@ -447,21 +819,28 @@ int main() {
                 
                 // Processa com CPU (referência)
                 printf("Processando com CPU (referência)...\n");
-                operation_filter_cpu(sobel_gx_5x5, sobel_gy_5x5, 3, filter_result_cpu, 0);
-                sprintf(cpu_output, "2_sobel_5x5_cpu.png");
+                status = operation_filter_cpu(&grayscale, sobel_gx_5x5, sobel_gy_5x5, 3, &filter_result_cpu, 0);
+                sprintf(cpu_output, "2_sobel_5x5_cpu");
                 
                 // Processa com FPGA
                 printf("Processando com FPGA...\n");
-                operation_filter(sobel_gx_5x5, sobel_gy_5x5, 3, filter_result, 0);
-                sprintf(output, "2_sobel_5x5_fpga.png");
+                if (status == 0) status = operation_filter(&grayscale, sobel_gx_5x5, sobel_gy_5x5, 3, &filter_result, 0);
+                sprintf(output, "2_sobel_5x5_fpga");
+                
+                // Com falha, os planos reaproveitados têm dados de outro filtro
+                if (status != 0) {
+                    image_free(&filter_result_cpu);
+                    image_free(&filter_result);
+                    break;
+                }
                 
                 // Calcula porcentagem de diferença
-                percentage_diff = calculate_percentage_difference(filter_result_cpu, filter_result);
+                percentage_diff = calculate_percentage_difference(&filter_result_cpu, &filter_result);
                 print_percentage_report(percentage_diff, "Sobel 5x5");
                 
                 // Salva imagens
-                save_grayscale_png(cpu_output, filter_result_cpu);
-                save_grayscale_png(output, filter_result);
+                save_grayscale(cpu_output, &filter_result_cpu);
+                save_grayscale(output, &filter_result);
                 break;
                 
             case 3:
@@ -469,21 +848,28 @@ int main() {
                 
                 // Processa com CPU (referência)
                 printf("Processando com CPU (referência)...\n");
-                operation_filter_cpu(prewitt_gx_3x3, prewitt_gy_3x3, 1, filter_result_cpu, 0);
-                sprintf(cpu_output, "3_prewitt_3x3_cpu.png");
+                status = operation_filter_cpu(&grayscale, prewitt_gx_3x3, prewitt_gy_3x3, 1, &filter_result_cpu, 0);
+                sprintf(cpu_output, "3_prewitt_3x3_cpu");
                 
                 // Processa com FPGA
                 printf("Processando com FPGA...\n");
-                operation_filter(prewitt_gx_3x3, prewitt_gy_3x3, 1, filter_result, 0);
-                sprintf(output, "3_prewitt_3x3_fpga.png");
+                if (status == 0) status = operation_filter(&grayscale, prewitt_gx_3x3, prewitt_gy_3x3, 1, &filter_result, 0);
+                sprintf(output, "3_prewitt_3x3_fpga");
+                
+                // Com falha, os planos reaproveitados têm dados de outro filtro
+                if (status != 0) {
+                    image_free(&filter_result_cpu);
+                    image_free(&filter_result);
+                    break;
+                }
                 
                 // Calcula porcentagem de diferença
-                percentage_diff = calculate_percentage_difference(filter_result_cpu, filter_result);
+                percentage_diff = calculate_percentage_difference(&filter_result_cpu, &filter_result);
                 print_percentage_report(percentage_diff, "Prewitt 3x3");
                 
                 // Salva imagens
-                save_grayscale_png(cpu_output, filter_result_cpu);
-                save_grayscale_png(output, filter_result);
+                save_grayscale(cpu_output, &filter_result_cpu);
+                save_grayscale(output, &filter_result);
                 break;
                 
             case 4:
@@ -491,21 +877,28 @@ int main() {
                 
                 // Processa com CPU (referência)
                 printf("Processando com CPU (referência)...\n");
-                operation_filter_cpu(roberts_gx_2x2, roberts_gy_2x2, 0, filter_result_cpu, 0);
-                sprintf(cpu_output, "4_roberts_2x2_cpu.png");
+                status = operation_filter_cpu(&grayscale, roberts_gx_2x2, roberts_gy_2x2, 0, &filter_result_cpu, 0);
+                sprintf(cpu_output, "4_roberts_2x2_cpu");
                 
                 // Processa com FPGA
                 printf("Processando com FPGA...\n");
-                operation_filter(roberts_gx_2x2, roberts_gy_2x2, 0, filter_result, 0);
-                sprintf(output, "4_roberts_2x2_fpga.png");
+                if (status == 0) status = operation_filter(&grayscale, roberts_gx_2x2, roberts_gy_2x2, 0, &filter_result, 0);
+                sprintf(output, "4_roberts_2x2_fpga");
+                
+                // Com falha, os planos reaproveitados têm dados de outro filtro
+                if (status != 0) {
+                    image_free(&filter_result_cpu);
+                    image_free(&filter_result);
+                    break;
+                }
                 
                 // Calcula porcentagem de diferença
-                percentage_diff = calculate_percentage_difference(filter_result_cpu, filter_result);
+                percentage_diff = calculate_percentage_difference(&filter_result_cpu, &filter_result);
                 print_percentage_report(percentage_diff, "Roberts 2x2");
                 
                 // Salva imagens
-                save_grayscale_png(cpu_output, filter_result_cpu);
-                save_grayscale_png(output, filter_result);
+                save_grayscale(cpu_output, &filter_result_cpu);
+                save_grayscale(output, &filter_result);
                 break;
                 
             case 5:
@@ -513,21 +906,79 @@ int main() {
                 
                 // Processa com CPU (referência)
                 printf("Processando com CPU (referência)...\n");
-                operation_filter_cpu(laplaciano_5x5, kernel_zero, 3, filter_result_cpu, 1);
-                sprintf(cpu_output, "5_laplaciano_5x5_cpu.png");
+                status = operation_filter_cpu(&grayscale, laplaciano_5x5, kernel_zero, 3, &filter_result_cpu, 1);
+                sprintf(cpu_output, "5_laplaciano_5x5_cpu");
                 
                 // Processa com FPGA
                 printf("Processando com FPGA...\n");
-                operation_filter(laplaciano_5x5, kernel_zero, 3, filter_result, 1);
-                sprintf(output, "5_laplaciano_5x5_fpga.png");
+                if (status == 0) status = operation_filter(&grayscale, laplaciano_5x5, kernel_zero, 3, &filter_result, 1);
+                sprintf(output, "5_laplaciano_5x5_fpga");
+                
+                // Com falha, os planos reaproveitados têm dados de outro filtro
+                if (status != 0) {
+                    image_free(&filter_result_cpu);
+                    image_free(&filter_result);
+                    break;
+                }
                 
                 // Calcula porcentagem de diferença
-                percentage_diff = calculate_percentage_difference(filter_result_cpu, filter_result);
+                percentage_diff = calculate_percentage_difference(&filter_result_cpu, &filter_result);
                 print_percentage_report(percentage_diff, "Laplaciano 5x5");
                 
                 // Salva imagens
-                save_grayscale_png(cpu_output, filter_result_cpu);
-                save_grayscale_png(output, filter_result);
+                save_grayscale(cpu_output, &filter_result_cpu);
+                save_grayscale(output, &filter_result);
+                break;
+                
+            case 6:
+                printf("\nAplicando os cinco filtros numa única passada...\n");
+                
+                // Os planos de saída só existem enquanto este modo roda
+                for (i = 0; i < NUM_FILTERS; i++) {
+                    all_result_cpu[i].data = NULL;
+                    all_result[i].data = NULL;
+                }
+                for (i = 0; i < NUM_FILTERS; i++) {
+                    if (image_writer_acquire(out_writer, &all_result_cpu[i], grayscale.width, grayscale.height, 1) != 0 ||
+                        image_writer_acquire(out_writer, &all_result[i], grayscale.width, grayscale.height, 1) != 0) {
+                        break;
+                    }
+                }
+                if (i < NUM_FILTERS) {
+                    fprintf(stderr, "Falta de memória para os planos de saída\n");
+                    for (i = 0; i < NUM_FILTERS; i++) {
+                        image_free(&all_result_cpu[i]);
+                        image_free(&all_result[i]);
+                    }
+                    break;
+                }
+                
+                // Processa com CPU (referência)
+                printf("Processando com CPU (referência)...\n");
+                status = operation_filter_all_cpu(&grayscale, all_result_cpu);
+                
+                // Processa com FPGA
+                printf("Processando com FPGA...\n");
+                if (status == 0) status = operation_filter_all(&grayscale, all_result);
+                
+                // Com falha, algum plano ficou com dados de outro filtro: nada é salvo
+                if (status != 0) {
+                    for (i = 0; i < NUM_FILTERS; i++) {
+                        image_free(&all_result_cpu[i]);
+                        image_free(&all_result[i]);
+                    }
+                    break;
+                }
+                
+                for (i = 0; i < NUM_FILTERS; i++) {
+                    percentage_diff = calculate_percentage_difference(&all_result_cpu[i], &all_result[i]);
+                    print_percentage_report(percentage_diff, all_filters[i].name);
+                    
+                    sprintf(cpu_output, "%s_cpu", all_filters[i].file);
+                    sprintf(output, "%s_fpga", all_filters[i].file);
+                    save_grayscale(cpu_output, &all_result_cpu[i]);
+                    save_grayscale(output, &all_result[i]);
+                }
                 break;
                 
             default:
@@ -536,9 +987,13 @@ int main() {
         }
     }
     
-    // Limpa os recursos
+    // Limpa os recursos (antes espera as gravações pendentes)
+    image_writer_destroy(out_writer);
+    thread_pool_destroy(png_pool);
     printf("Liberando recursos do hardware...\n");
-    close_hw_access();
-    
+    hw->close();
+    thread_pool_destroy(cpu_pool);
+    image_free(&grayscale);
+
     return EXIT_SUCCESS;
 }
\ No newline at end of file
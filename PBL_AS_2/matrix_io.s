@@ -1,4 +1,10 @@
+@ Sintaxe unificada (UAL): condicionais como LDRBLT em send_pixels
+.syntax unified
 .equ DELAY_CYCLES, 10
+@ Comandos em [18:16] do pulso de start (ControlUnit.v)
+.equ OP_NEW_ROW, 0           @ janela inteira, no início de cada linha
+.equ OP_LOAD_KERNELS, 1      @ Gx/Gy para as janelas seguintes
+.equ OP_NEXT_COLUMN, 2       @ lote de colunas que entram na janela
 
 .section .data
 devmem_path: .asciz "/dev/mem"
@@ -14,6 +20,9 @@ data_out_ptr: .word 0       @ ponteiro para base do data_out
 .global fd_mem 
 fd_mem: .space 4              @ file descriptor do open()
 
+last_command: .word 0xFFFFFFFF  @ último comando enviado (campos do pulso de start)
+hps_seq: .word 0                @ bit de sequência do handshake (0 ou 1 << 31)
+
 .section .text  
 
 @ Definicao de funcoes
@@ -23,9 +32,15 @@ fd_mem: .space 4              @ file descriptor do open()
 .global close_hw_access
 .type close_hw_access, %function
 
+.global load_kernels
+.type load_kernels, %function
+
 .global send_all_data
 .type send_all_data, %function
 
+.global send_column
+.type send_column, %function
+
 .global read_all_results
 .type read_all_results, %function
 
@@ -125,130 +140,232 @@ skip_close:
     POP {r4-r7, lr}
     BX lr
 
-@ void send_all_data(*params)
-send_all_data:
+@ int load_kernels(*params): grava b (Gx) e c (Gy) nos registradores da FPGA,
+@ que valem para todas as janelas seguintes até o próximo load_kernels. É o
+@ início da sessão de um filtro: o único reset da FPGA até o próximo filtro
+load_kernels:
     PUSH {r3-r12, lr}
-    LDR r4, [r0]            @ a (pixel window)
     LDR r5, [r0, #4]        @ b (kernel Gx)
-    LDR r6, [r0, #8]        @ opcode
-    LDR r7, [r0, #12]       @ size
     LDR r8, [r0, #16]       @ c (kernel Gy)
 
-    LDR r2, =data_in_ptr
-    LDR r2, [r2] 
-
-    MOV r9, #1
-    LSL r9, r9, #29
-    MOV r0, r9              @ r0 = reset bit (bit 29 = 1)
-    STR r0, [r2]            
-    MOV r0, #0
-    STR r0, [r2]            @ limpa (pulso rápido)
-        
-    MOV r11, #DELAY_CYCLES              
-    BL delay_loop
-
-    MOV r9, #1
-    LSL r9, r9, #30
-    MOV r0, r9              @ r0 = start bit (bit 30 = 1)
-    STR r0, [r2]            
-    MOV r0, #0
-    STR r0, [r2]            @ limpa (pulso rápido)
+    MOV r0, #(OP_LOAD_KERNELS << 16)
+    BL start_session
 
     MOV r9, #25             @ número máximo de elementos (5x5)
     MOV r10, #0             @ índice = 0
 
-loop_send:
+loop_load:
     CMP r10, r9
-    BGE end_send            
-    LDRB r0,  [r4, r10]     @ r0 = pixel (sem sinal)
+    BGE end_load
     LDRSB r1, [r5, r10]     @ r1 = kernel Gx
-    LDRSB r12, [r8, r10]    @ r3 = kernel Gy
+    LDRSB r12, [r8, r10]    @ r12 = kernel Gy
 
-    AND r0, r0, #0xFF       @ Pixel [7:0]
-    AND r1, r1, #0xFF       @ Kernel Gx [7:0]
-    AND r12, r12, #0xFF     @ Kernel Gy [7:0]
-    
-    @ Empacota: [31]  | [28:21] Gy | [20:19] size | [18:16] opcode | [15:8] Gx | [7:0] pixel        
-    LSL r1, r1, #8           
-    ORR r0, r0, r1  
-    ORR r0, r0, r6, LSL #16
-    ORR r0, r0, r7, LSL #19  
-    ORR r0, r0, r12,LSL #21 
-    
-    PUSH {r0}              
-    MOV r1, #1              
-    BL handshake_send       
-    POP {r0}                
+    AND r1, r1, #0xFF
+    AND r12, r12, #0xFF
+
+    @ Empacota: [31] | [28:21] Gy | [15:8] Gx
+    LSL r0, r1, #8
+    ORR r0, r0, r12, LSL #21
+
+    BL handshake_send
     ADD r10, r10, #1
-    B loop_send
+    B loop_load
+
+end_load:
+    MOV r0, #0              @ Retorna sucesso
+    POP {r3-r12, lr}
+    BX lr
+
+@ void send_all_data(*params): janela inteira no início de uma linha, n x n pixels
+@ com n = size + 2, três por palavra; os kernels já estão na FPGA (load_kernels)
+send_all_data:
+    PUSH {r3-r12, lr}
+    LDR r4, [r0]            @ a (pixel window)
+    LDR r6, [r0, #8]        @ opcode
+    LDR r7, [r0, #12]       @ size
+
+    @ Comando: [23:21] opcode | [20:19] size | [18:16] OP_NEW_ROW
+    MOV r0, #(OP_NEW_ROW << 16)
+    ORR r0, r0, r7, LSL #19
+    ORR r0, r0, r6, LSL #21
+    BL start_command
+
+    ADD r1, r7, #2          @ n = lado da janela
+    MUL r9, r1, r1          @ número de pixels (n x n)
+    BL send_pixels
+
+    MOV r0, #0              @ Retorna sucesso
+    POP {r3-r12, lr}
+    BX lr
+
+@ int send_column(*params): a traz columns colunas (1 a 3) de n = size + 2 pixels,
+@ uma após a outra, que entram à direita da janela; a FPGA desloca a janela e
+@ calcula um resultado por coluna. Depois de um lote a FPGA já espera outro igual,
+@ então o pulso de start só sai quando o comando muda
+send_column:
+    PUSH {r3-r12, lr}
+    LDR r4, [r0]            @ a (colunas novas)
+    LDR r6, [r0, #8]        @ opcode
+    LDR r7, [r0, #12]       @ size
+    LDR r8, [r0, #20]       @ columns
+
+    @ Comando: [25:24] colunas | [23:21] opcode | [20:19] size | [18:16] OP_NEXT_COLUMN
+    MOV r0, #(OP_NEXT_COLUMN << 16)
+    ORR r0, r0, r7, LSL #19
+    ORR r0, r0, r6, LSL #21
+    ORR r0, r0, r8, LSL #24
+    @ Invariante: OP_NEW_ROW != OP_NEXT_COLUMN, então depois de send_all_data o pulso sempre sai
+    LDR r1, =last_command
+    LDR r1, [r1]
+    CMP r0, r1
+    BLNE start_command      @ mesmo comando do lote anterior: a FPGA já espera os pixels
+
+    ADD r1, r7, #2          @ n = pixels por coluna
+    MUL r9, r1, r8          @ número de pixels (n x colunas)
+    BL send_pixels
 
-end_send:
     MOV r0, #0              @ Retorna sucesso
     POP {r3-r12, lr}
     BX lr
 
+@ Envia os r9 pixels de r4, três por palavra: [23:16] | [15:8] | [7:0]
+send_pixels:
+    PUSH {r10, r12, lr}
+    MOV r10, #0             @ índice = 0
+
+loop_pixels:
+    CMP r10, r9
+    BGE end_pixels
+    LDRB r0, [r4, r10]      @ r0 = primeiro pixel (sem sinal)
+    ADD r10, r10, #1
+    CMP r10, r9
+    LDRBLT r12, [r4, r10]   @ segundo pixel, se existir
+    ORRLT r0, r0, r12, LSL #8
+    ADDLT r10, r10, #1
+    CMP r10, r9
+    LDRBLT r12, [r4, r10]   @ terceiro pixel, se existir
+    ORRLT r0, r0, r12, LSL #16
+    ADDLT r10, r10, #1
+
+    BL handshake_send
+    B loop_pixels
+
+end_pixels:
+    POP {r10, r12, lr}
+    BX lr
+
+@ Pulso de start com os campos do comando já em r0, guardados em last_command.
+@ O bit 31 repete a sequência atual: o pulso não é um pedido de handshake
+start_command:
+    PUSH {r1, r2, lr}
+    LDR r2, =data_in_ptr
+    LDR r2, [r2]
+    LDR r1, =last_command
+    STR r0, [r1]
+    LDR r1, =hps_seq
+    LDR r1, [r1]
+
+    ORR r0, r0, #(1 << 30)  @ r0 = start bit (bit 30 = 1) | comando
+    ORR r0, r0, r1
+    STR r0, [r2]
+    STR r1, [r2]            @ limpa (pulso rápido)
+
+    POP {r1, r2, lr}
+    BX lr
+
+@ Início de sessão (um filtro): pulso de reset, espera e o comando de r0
+start_session:
+    PUSH {r1, r2, r11, lr}
+    LDR r2, =data_in_ptr
+    LDR r2, [r2]
+
+    MOV r1, #(1 << 29)      @ r1 = reset bit (bit 29 = 1)
+    STR r1, [r2]
+    MOV r1, #0
+    STR r1, [r2]            @ limpa (pulso rápido)
+    LDR r2, =hps_seq
+    STR r1, [r2]            @ o reset zera o ACK: a sequência recomeça em 0
+    MVN r1, #0
+    LDR r2, =last_command
+    STR r1, [r2]            @ a FPGA esqueceu o último comando
+
+    MOV r11, #DELAY_CYCLES
+    BL delay_loop
+
+    BL start_command
+    POP {r1, r2, r11, lr}
+    BX lr
+
 delay_loop:
     SUBS r11, r11, #1
     BNE delay_loop
     BX lr
 
-@ int read_all_results(uint8_t* result)
+@ int read_all_results(uint8_t* result): os pixels do último comando vêm numa
+@ única palavra, [25:24] quantos | [23:0] até três pixels; grava só os válidos
 read_all_results:
     PUSH {r4-r7, lr}
     MOV r4, r0           
-    MOV r6, #25         
-    MOV r7, #0         
+    SUB sp, sp, #8          @ palavra lida de data_out
 
-.loop_recv:
-    CMP r7, r6
-    BGE .done           
-    MOV r0, r4
-    ADD r0, r0, r7       
+    MOV r0, sp
     BL handshake_receive 
     CMP r0, #0           
     BNE .error          
-    ADD r7, r7, #1       
-    B .loop_recv         
-.error:
-    MOV r0, #1           
-    B .exit
+
+    LDR r5, [sp]
+    LSR r6, r5, #24
+    AND r6, r6, #3          @ r6 = pixels válidos
+    MOV r7, #0
+.loop_recv:
+    CMP r7, r6
+    BGE .done
+    STRB r5, [r4, r7]       @ result[i] = bits [8i+7:8i]
+    LSR r5, r5, #8
+    ADD r7, r7, #1
+    B .loop_recv
 .done:
     MOV r0, #0          
+    B .exit
+.error:
+    MOV r0, #1           
 .exit:
+    ADD sp, sp, #8
     POP {r4-r7, lr}
     BX lr               
 
+@ Handshake de duas fases: cada transferência inverte o bit 31 (hps_seq) e
+@ termina quando o ACK da FPGA (bit 31 de data_out) fica igual a ele. Não há
+@ volta a zero, então é uma espera por palavra em vez de duas
+
 @ void handshake_send(uint32_t value)
 handshake_send:
-    PUSH {r1-r4, lr}
+    PUSH {r1-r5, lr}
     @ r0 = valor original
     LDR r1, =data_in_ptr
     LDR r1, [r1]          
     @ Lê ponteiro para data_out
     LDR r2, =data_out_ptr
     LDR r2, [r2]       
-    @ --- Etapa 1: Escreve valor com bit 31 ligado ---
-    ORR r3, r0, #(1 << 31)     
-    STR r3, [r1]               
-    @ --- Etapa 2: Espera FPGA_ACK = 1 ---
-.wait_ack_high_send:
-    LDR r4, [r2]               
-    TST r4, #(1 << 31)         
-    BEQ .wait_ack_high_send
-    @ --- Etapa 3: Confirma recebimento → escreve 0 ---
-    MOV r3, #0
+    @ --- Etapa 1: Inverte a sequência e escreve o valor com ela no bit 31 ---
+    LDR r5, =hps_seq
+    LDR r4, [r5]
+    EOR r4, r4, #(1 << 31)
+    STR r4, [r5]
+    ORR r3, r0, r4
     STR r3, [r1]               
-    @ --- Etapa 4: Espera FPGA_ACK = 0 ---
-.wait_ack_low_send:
-    LDR r4, [r2]
-    TST r4, #(1 << 31)
-    BNE .wait_ack_low_send
-    POP {r1-r4, lr}
+    @ --- Etapa 2: Espera FPGA_ACK = sequência ---
+.wait_ack_send:
+    LDR r3, [r2]               
+    EOR r3, r3, r4
+    TST r3, #(1 << 31)         
+    BNE .wait_ack_send
+    POP {r1-r5, lr}
     BX lr
 
-@ int handshake_receive(uint8_t* value_out)
+@ int handshake_receive(uint32_t* value_out)
 handshake_receive:
-    PUSH {r2-r5, lr}
+    PUSH {r2-r6, lr}
     LDR r2, =data_in_ptr     
     LDR r2, [r2]
     LDR r3, =data_out_ptr  
@@ -257,30 +374,24 @@ handshake_receive:
     BEQ .handshake_error     
     CMP r3, #0
     BEQ .handshake_error     
-    @ Envia sinal de pronto para FPGA
-    MOV r4, #(1 << 31)       
+    @ Pede a palavra: só a sequência invertida no bit 31
+    LDR r6, =hps_seq
+    LDR r4, [r6]
+    EOR r4, r4, #(1 << 31)
+    STR r4, [r6]
     STR r4, [r2]     
-    @ Aguarda FPGA sinalizar que enviou dados (bit 31=1 em data_out)
-.wait_ack_high_recei:
+    @ Aguarda FPGA sinalizar que enviou dados (ACK = sequência)
+.wait_ack_recei:
     LDR r5, [r3]             
-    TST r5, #(1 << 31)       @ Testa se bit 31 está ativo
-    BEQ .wait_ack_high_recei 
-    @ Extrai o valor da matriz (bits [7:0])
-    AND r4, r5, #0xFF        
-    STRB r4, [r0]            
-    @ Confirma a leitura desativando o bit de controle
-    MOV r4, #0
-    STR r4, [r2]            
-    @ Aguarda FPGA desativar seu sinal de pronto
-.wait_ack_low_recei:
-    LDR r5, [r3]
-    TST r5, #(1 << 31)
-    BNE .wait_ack_low_recei
+    EOR r6, r5, r4
+    TST r6, #(1 << 31)       @ Testa se o ACK já alcançou a sequência
+    BNE .wait_ack_recei 
+    @ Guarda a palavra inteira (ACK incluso)
+    STR r5, [r0]            
     MOV r0, #0               
     B .handshake_exit
 .handshake_error:
     MOV r0, #1               
 .handshake_exit:
-    POP {r2-r5, lr}
+    POP {r2-r6, lr}
     BX lr
-    
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include "png_write.h"
+
+// Folga antes dos dados de cada faixa (cabeçalho zlib na primeira) e depois (adler32 na última)
+#define PNG_ZLIB_HEAD 2
+#define PNG_ZLIB_TAIL 4
+
+typedef struct {
+    uint8_t* data;          // PNG_ZLIB_HEAD bytes livres + deflate da faixa
+    size_t size;            // Bytes de deflate
+    size_t capacity;        // Bytes de deflate que cabem sem realocar (sem contar as folgas)
+    uLong adler;            // adler32 dos dados filtrados da faixa
+    size_t length;          // Dados filtrados: (1 + bytes por linha) * linhas
+    int error;
+} png_strip_t;
+
+typedef struct {
+    const image_t* img;
+    int level;
+    int rows;               // Linhas por faixa (a última pode ter menos)
+    int count;
+    png_strip_t* strips;
+} png_job_t;
+
+/* ========== FILTROS ========== */
+
+static uint8_t png_paeth(int a, int b, int c) {
+    int p = a + b - c;
+    int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+
+    if (pa <= pb && pa <= pc) return (uint8_t)a;
+    if (pb <= pc) return (uint8_t)b;
+    return (uint8_t)c;
+}
+
+static unsigned png_cost(const uint8_t* f, size_t n) {
+    unsigned sum = 0;
+    size_t i;
+
+    for (i = 0; i < n; i++) sum += (unsigned)abs((int8_t)f[i]);
+    return sum;
+}
+
+// Aplica os 5 filtros em cand (5 linhas de 1 + n bytes, o primeiro é o tipo) e
+// devolve a de menor soma dos valores com sinal, a heurística do libpng.
+// prev NULL = primeira linha da imagem (acima dela tudo é zero)
+static const uint8_t* png_filter_row(const uint8_t* cur, const uint8_t* prev, size_t n, int bpp, uint8_t* cand) {
+    uint8_t* f[5];
+    const uint8_t* best;
+    unsigned cost, best_cost;
+    size_t i;
+    int t;
+
+    for (t = 0; t < 5; t++) {
+        f[t] = cand + (size_t)t * (n + 1);
+        f[t][0] = (uint8_t)t;
+        f[t]++;
+    }
+    for (i = 0; i < n; i++) {
+        int a = (i >= (size_t)bpp) ? cur[i - bpp] : 0;
+        int b = prev ? prev[i] : 0;
+        int c = (prev && i >= (size_t)bpp) ? prev[i - bpp] : 0;
+
+        f[0][i] = cur[i];
+        f[1][i] = (uint8_t)(cur[i] - a);
+        f[2][i] = (uint8_t)(cur[i] - b);
+        f[3][i] = (uint8_t)(cur[i] - ((a + b) >> 1));
+        f[4][i] = (uint8_t)(cur[i] - png_paeth(a, b, c));
+    }
+
+    best = f[0] - 1;
+    best_cost = png_cost(f[0], n);
+    for (t = 1; t < 5; t++) {
+        cost = png_cost(f[t], n);
+        if (cost < best_cost) {
+            best_cost = cost;
+            best = f[t] - 1;
+        }
+    }
+    return best;
+}
+
+/* ========== COMPRESSÃO DE UMA FAIXA ========== */
+
+static int png_strip_grow(png_strip_t* s) {
+    size_t capacity = s->capacity * 2;
+    uint8_t* data = (uint8_t*)realloc(s->data, PNG_ZLIB_HEAD + capacity + PNG_ZLIB_TAIL);
+
+    if (!data) return -1;
+    s->data = data;
+    s->capacity = capacity;
+    return 0;
+}
+
+static void png_deflate_strip(void* arg, int index) {
+    png_job_t* job = (png_job_t*)arg;
+    const image_t* img = job->img;
+    png_strip_t* s = &job->strips[index];
+    size_t n = (size_t)img->width * img->channels;
+    int y0 = index * job->rows;
+    int y1 = (y0 + job->rows < img->height) ? y0 + job->rows : img->height;
+    int last = (index == job->count - 1);
+    uint8_t* cand;
+    z_stream z;
+    int y;
+
+    s->error = 1;
+    cand = (uint8_t*)malloc(5 * (n + 1));
+    memset(&z, 0, sizeof(z));
+    // Deflate cru (janela negativa): o cabeçalho e o adler32 são do fluxo inteiro
+    if (!cand || deflateInit2(&z, job->level, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+        free(cand);
+        return;
+    }
+    s->length = (n + 1) * (size_t)(y1 - y0);
+    s->capacity = deflateBound(&z, (uLong)s->length) + 16;    // + marcador do sync flush
+    s->data = (uint8_t*)malloc(PNG_ZLIB_HEAD + s->capacity + PNG_ZLIB_TAIL);
+    s->adler = adler32(0L, Z_NULL, 0);
+    if (!s->data) goto done;
+
+    for (y = y0; y < y1; y++) {
+        const uint8_t* row = png_filter_row(image_row(img, y), y ? image_row(img, y - 1) : NULL,
+                                            n, img->channels, cand);
+        int flush = (y < y1 - 1) ? Z_NO_FLUSH : (last ? Z_FINISH : Z_SYNC_FLUSH);
+
+        s->adler = adler32(s->adler, row, (uInt)(n + 1));
+        z.next_in = (Bytef*)row;
+        z.avail_in = (uInt)(n + 1);
+        // Saída cheia significa que pode haver mais a gravar; senão a linha (e o flush) acabou
+        do {
+            if (s->size == s->capacity && png_strip_grow(s) != 0) goto done;
+            z.next_out = s->data + PNG_ZLIB_HEAD + s->size;
+            z.avail_out = (uInt)(s->capacity - s->size);
+            if (deflate(&z, flush) == Z_STREAM_ERROR) goto done;
+            s->size = s->capacity - z.avail_out;
+        } while (z.avail_out == 0);
+    }
+    s->error = 0;
+
+done:
+    deflateEnd(&z);
+    free(cand);
+}
+
+/* ========== ARQUIVO ========== */
+
+static void png_put32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static int png_write_chunk(FILE* f, const char* type, const uint8_t* data, size_t len) {
+    uint8_t head[8], tail[4];
+    uLong crc = crc32(0L, (const Bytef*)type, 4);
+
+    if (len) crc = crc32(crc, data, (uInt)len);
+    png_put32(head, (uint32_t)len);
+    memcpy(head + 4, type, 4);
+    png_put32(tail, (uint32_t)crc);
+    if (fwrite(head, 1, 8, f) != 8) return -1;
+    if (len && fwrite(data, 1, len, f) != len) return -1;
+    if (fwrite(tail, 1, 4, f) != 4) return -1;
+    return 0;
+}
+
+int png_write(const char* filename, const image_t* img, int level, thread_pool_t* pool) {
+    static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    static const uint8_t color_type[5] = { 0, 0, 4, 2, 6 };
+    size_t total = ((size_t)img->width * img->channels + 1) * (size_t)img->height;
+    int strips = 1, flevel, ret = -1, i;
+    uint8_t ihdr[13];
+    png_job_t job;
+    uLong adler;
+    FILE* f = NULL;
+
+    if (img->channels < 1 || img->channels > 4 || img->width <= 0 || img->height <= 0) return -1;
+    if (level < 0) level = 0;
+    if (level > 9) level = 9;
+
+    // Faixas de pelo menos PNG_STRIP_MIN_BYTES, algumas por thread
+    if (thread_pool_size(pool) > 1) {
+        size_t by_size = total / PNG_STRIP_MIN_BYTES;
+
+        strips = thread_pool_size(pool) * PNG_STRIPS_PER_THREAD;
+        if ((size_t)strips > by_size) strips = by_size ? (int)by_size : 1;
+    }
+    job.img = img;
+    job.level = level;
+    job.rows = (img->height + strips - 1) / strips;
+    job.count = (img->height + job.rows - 1) / job.rows;
+    job.strips = (png_strip_t*)calloc((size_t)job.count, sizeof(png_strip_t));
+    if (!job.strips) return -1;
+
+    thread_pool_run(pool, png_deflate_strip, &job, job.count);
+    for (i = 0; i < job.count; i++) {
+        if (job.strips[i].error) goto done;
+    }
+
+    // Cabeçalho zlib: deflate com janela de 32 KB, FLEVEL conforme o nível, FCHECK múltiplo de 31
+    flevel = (level < 2) ? 0 : (level < 6) ? 1 : (level == 6) ? 2 : 3;
+    job.strips[0].data[0] = 0x78;
+    job.strips[0].data[1] = (uint8_t)(flevel << 6);
+    job.strips[0].data[1] += (uint8_t)(31 - (0x7800 + job.strips[0].data[1]) % 31);
+
+    adler = job.strips[0].adler;
+    for (i = 1; i < job.count; i++) {
+        adler = adler32_combine(adler, job.strips[i].adler, (z_off_t)job.strips[i].length);
+    }
+    png_put32(job.strips[job.count - 1].data + PNG_ZLIB_HEAD + job.strips[job.count - 1].size, (uint32_t)adler);
+
+    png_put32(ihdr, (uint32_t)img->width);
+    png_put32(ihdr + 4, (uint32_t)img->height);
+    ihdr[8] = 8;                            // Bits por amostra
+    ihdr[9] = color_type[img->channels];
+    ihdr[10] = ihdr[11] = ihdr[12] = 0;     // Deflate, filtro adaptativo, sem entrelaçamento
+
+    f = fopen(filename, "wb");
+    if (!f) goto done;
+    if (fwrite(signature, 1, 8, f) != 8 || png_write_chunk(f, "IHDR", ihdr, 13) != 0) goto done;
+    // Um IDAT por faixa; o primeiro leva o cabeçalho zlib e o último o adler32
+    for (i = 0; i < job.count; i++) {
+        png_strip_t* s = &job.strips[i];
+        size_t head = (i == 0) ? PNG_ZLIB_HEAD : 0;
+        size_t tail = (i == job.count - 1) ? PNG_ZLIB_TAIL : 0;
+
+        if (png_write_chunk(f, "IDAT", s->data + PNG_ZLIB_HEAD - head, head + s->size + tail) != 0) goto done;
+    }
+    if (png_write_chunk(f, "IEND", NULL, 0) != 0) goto done;
+    ret = 0;
+
+done:
+    if (f && fclose(f) != 0) ret = -1;
+    for (i = 0; i < job.count; i++) free(job.strips[i].data);
+    free(job.strips);
+    return ret;
+}
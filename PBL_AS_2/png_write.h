@@ -0,0 +1,27 @@
+#ifndef PNG_WRITE_H
+#define PNG_WRITE_H
+#include "image.h"
+#include "thread_pool.h"
+
+/* ========== PNG COM DEFLATE EM FAIXAS PARALELAS ==========
+ *
+ * A imagem é dividida em faixas horizontais e cada faixa é filtrada (filtro
+ * adaptativo por linha, como no libpng) e comprimida por uma tarefa do pool,
+ * com um deflate próprio. As faixas do meio terminam com Z_SYNC_FLUSH (bloco
+ * vazio alinhado em byte, sem bit de fim), então basta concatená-las entre o
+ * cabeçalho zlib e o adler32 combinado para formar um único fluxo válido.
+ * Cada faixa perde só as referências à anterior (janela de 32 KB), um custo
+ * desprezível com faixas de centenas de KB.
+ */
+
+// Tamanho mínimo (dados filtrados) de cada faixa
+#define PNG_STRIP_MIN_BYTES (256 * 1024)
+// Faixas por thread do pool, para equilibrar faixas que comprimem em tempos diferentes
+#define PNG_STRIPS_PER_THREAD 4
+
+// Grava img (1 a 4 canais) com nível zlib 0 a 9. pool NULL comprime tudo numa faixa,
+// na thread atual. O pool não pode estar em uso por outra thread durante a chamada.
+// 0 = sucesso, -1 = erro
+int png_write(const char* filename, const image_t* img, int level, thread_pool_t* pool);
+
+#endif
@@ -0,0 +1,274 @@
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "resample.h"
+#include "image.h"
+
+/* ========== MODOS ========== */
+
+int resample_mode_parse(const char* name, resample_mode_t* mode) {
+    if (strcmp(name, "auto") == 0) *mode = RESAMPLE_AUTO;
+    else if (strcmp(name, "area") == 0) *mode = RESAMPLE_AREA;
+    else if (strcmp(name, "bilinear") == 0) *mode = RESAMPLE_BILINEAR;
+    else if (strcmp(name, "nearest") == 0) *mode = RESAMPLE_NEAREST;
+    else return -1;
+    return 0;
+}
+
+const char* resample_mode_name(resample_mode_t mode) {
+    switch (mode) {
+        case RESAMPLE_AREA:     return "area";
+        case RESAMPLE_BILINEAR: return "bilinear";
+        case RESAMPLE_NEAREST:  return "nearest";
+        default:                return "auto";
+    }
+}
+
+resample_mode_t resample_axis_mode(resample_mode_t mode, int in_size, int out_size) {
+    if (mode != RESAMPLE_AUTO) return mode;
+    if (out_size < in_size) return RESAMPLE_AREA;
+    if (out_size > in_size) return RESAMPLE_BILINEAR;
+    return RESAMPLE_NEAREST;    // Mesmo tamanho: cópia
+}
+
+/* ========== TABELAS POR EIXO ========== */
+
+// Saída i cobre [i * in, (i + 1) * in) e a origem j cobre [j * out, (j + 1) * out),
+// ambos em unidades de 1 / (in * out). Os pesos vêm da área acumulada arredondada,
+// então somam exatamente 'one'.
+static int resample_area_taps(int i, int in_size, int out_size, int one, int* first, uint16_t* w) {
+    int64_t lo = (int64_t)i * in_size, hi = lo + in_size;
+    int j0 = (int)(lo / out_size), j1 = (int)((hi - 1) / out_size);
+    int64_t cum = 0;
+    int prev = 0, n = 0, j;
+
+    for (j = j0; j <= j1; j++) {
+        int64_t a = (int64_t)j * out_size, b = a + out_size;
+        int cur;
+
+        if (a < lo) a = lo;
+        if (b > hi) b = hi;
+        cum += b - a;
+        cur = (int)((cum * one + in_size / 2) / in_size);
+        w[n++] = (uint16_t)(cur - prev);
+        prev = cur;
+    }
+    *first = j0;
+    return n;
+}
+
+// Centro da saída i na origem: (i + 0.5) * in / out - 0.5 = num / den
+static int resample_bilinear_taps(int i, int in_size, int out_size, int one, int* first, uint16_t* w) {
+    int64_t num = (int64_t)(2 * i + 1) * in_size - out_size, den = 2 * (int64_t)out_size;
+    int j0, frac;
+
+    if (num <= 0) {
+        *first = 0;
+        w[0] = one;
+        return 1;
+    }
+    j0 = (int)(num / den);
+    frac = (int)(((num % den) * one + den / 2) / den);
+    if (j0 >= in_size - 1 || frac == 0) {
+        *first = j0 < in_size ? j0 : in_size - 1;
+        w[0] = one;
+        return 1;
+    }
+    if (frac == one) {
+        *first = j0 + 1;
+        w[0] = one;
+        return 1;
+    }
+    *first = j0;
+    w[0] = (uint16_t)(one - frac);
+    w[1] = (uint16_t)frac;
+    return 2;
+}
+
+static int resample_nearest_taps(int i, int in_size, int out_size, int one, int* first, uint16_t* w) {
+    int j = (int)(((int64_t)i * in_size) / out_size);
+
+    *first = j < in_size ? j : in_size - 1;
+    w[0] = one;
+    return 1;
+}
+
+int resample_axis_init(resample_axis_t* axis, resample_mode_t mode, int in_size, int out_size, int one) {
+    int max_taps, i, used = 0;
+
+    memset(axis, 0, sizeof(*axis));
+    mode = resample_axis_mode(mode, in_size, out_size);
+    // Na média de área cada saída toca no máximo ceil(in / out) + 1 pixels de origem
+    max_taps = (mode == RESAMPLE_AREA) ? in_size / out_size + 2 : 2;
+
+    axis->out_size = out_size;
+    axis->start = (int*)malloc(sizeof(int) * out_size);
+    axis->count = (int*)malloc(sizeof(int) * out_size);
+    axis->offset = (int*)malloc(sizeof(int) * out_size);
+    axis->weight = (uint16_t*)malloc(sizeof(uint16_t) * (size_t)out_size * max_taps);
+    if (!axis->start || !axis->count || !axis->offset || !axis->weight) {
+        resample_axis_free(axis);
+        return -1;
+    }
+
+    for (i = 0; i < out_size; i++) {
+        uint16_t* w = axis->weight + used;
+        int first, n, skip = 0;
+
+        if (mode == RESAMPLE_AREA) n = resample_area_taps(i, in_size, out_size, one, &first, w);
+        else if (mode == RESAMPLE_BILINEAR) n = resample_bilinear_taps(i, in_size, out_size, one, &first, w);
+        else n = resample_nearest_taps(i, in_size, out_size, one, &first, w);
+
+        // Pesos que arredondaram para zero nas pontas não precisam de linha/coluna
+        while (n > 1 && w[n - 1] == 0) n--;
+        while (skip < n - 1 && w[skip] == 0) skip++;
+        if (skip) memmove(w, w + skip, sizeof(uint16_t) * (n - skip));
+
+        axis->start[i] = first + skip;
+        axis->count[i] = n - skip;
+        axis->offset[i] = used;
+        used += n - skip;
+        if (n - skip > axis->max_count) axis->max_count = n - skip;
+    }
+    return 0;
+}
+
+void resample_axis_free(resample_axis_t* axis) {
+    free(axis->start);
+    free(axis->count);
+    free(axis->offset);
+    free(axis->weight);
+    memset(axis, 0, sizeof(*axis));
+}
+
+/* ========== PASSE VERTICAL ESCALAR ========== */
+
+void resample_vacc_c(uint16_t* acc, const uint8_t* src, int width, int weight, int first) {
+    int x;
+
+    if (first) {
+        for (x = 0; x < width; x++) acc[x] = (uint16_t)(weight * src[x]);
+    } else {
+        for (x = 0; x < width; x++) acc[x] = (uint16_t)(acc[x] + weight * src[x]);
+    }
+}
+
+static const resample_ops_t resample_ops_c = {
+    "escalar",
+    resample_vacc_c
+};
+
+/* ========== ESCOLHA DA IMPLEMENTAÇÃO ========== */
+
+// Mesma política da conversão para cinza: a melhor versão suportada, ou a
+// indicada pela variável de ambiente RESAMPLE_SIMD (escalar, sse2, avx2 ou neon)
+static const resample_ops_t* resample_select_ops(void) {
+    const resample_ops_t* candidates[4];
+    const char* force = getenv("RESAMPLE_SIMD");
+    int i, n = 0;
+
+    candidates[n++] = resample_ops_avx2();
+    candidates[n++] = resample_ops_sse2();
+    candidates[n++] = resample_ops_neon();
+    candidates[n++] = &resample_ops_c;
+
+    for (i = 0; i < n; i++) {
+        if (!candidates[i]) continue;
+        if (!force || strcmp(force, candidates[i]->name) == 0) return candidates[i];
+    }
+    return &resample_ops_c;
+}
+
+static const resample_ops_t* resample_selected_ops = NULL;
+static pthread_once_t resample_ops_once = PTHREAD_ONCE_INIT;
+
+static void resample_ops_init(void) {
+    resample_selected_ops = resample_select_ops();
+}
+
+static const resample_ops_t* resample_ops(void) {
+    pthread_once(&resample_ops_once, resample_ops_init);
+    return resample_selected_ops;
+}
+
+const char* resample_simd_name(void) {
+    return resample_ops()->name;
+}
+
+/* ========== REDIMENSIONAMENTO ========== */
+
+// As duas últimas linhas de origem pedidas: a fronteira entre duas saídas da
+// média de área e o par da bilinear são reaproveitados sem chamar fetch de novo
+typedef struct {
+    int row[2];
+    const uint8_t* data[2];
+    uint8_t* scratch[2];
+    int last;
+} resample_cache_t;
+
+static const uint8_t* resample_cache_get(resample_cache_t* c, resample_fetch_fn fetch, void* arg, int y) {
+    int slot;
+
+    if (c->row[0] == y) slot = 0;
+    else if (c->row[1] == y) slot = 1;
+    else {
+        slot = 1 - c->last;
+        c->data[slot] = fetch(arg, y, c->scratch[slot]);
+        c->row[slot] = y;
+    }
+    c->last = slot;
+    return c->data[slot];
+}
+
+int resample_rows(resample_mode_t mode, resample_fetch_fn fetch, void* arg, int in_w, int in_h,
+                  uint8_t* dst, int dst_stride, int out_w, int out_h) {
+    resample_vacc_fn vacc = resample_ops()->vacc;
+    resample_axis_t h, v;
+    resample_cache_t cache;
+    uint16_t* acc = NULL;
+    int ret = -1, x, y, k;
+
+    memset(&cache, 0, sizeof(cache));
+    cache.row[0] = cache.row[1] = -1;
+    if (resample_axis_init(&h, mode, in_w, out_w, RESAMPLE_H_ONE) != 0) return -1;
+    if (resample_axis_init(&v, mode, in_h, out_h, RESAMPLE_V_ONE) != 0) {
+        resample_axis_free(&h);
+        return -1;
+    }
+    // Linha acumulada alinhada para as cargas vetoriais
+    if (posix_memalign((void**)&acc, IMAGE_ALIGN, sizeof(uint16_t) * (size_t)in_w) != 0) acc = NULL;
+    cache.scratch[0] = (uint8_t*)malloc((size_t)in_w);
+    cache.scratch[1] = (uint8_t*)malloc((size_t)in_w);
+    if (!acc || !cache.scratch[0] || !cache.scratch[1]) goto done;
+
+    for (y = 0; y < out_h; y++) {
+        const uint16_t* wv = v.weight + v.offset[y];
+        uint8_t* out = dst + (size_t)y * dst_stride;
+
+        // Vertical: acc = soma dos pesos Q8 vezes as linhas de origem (máximo 255 * 256)
+        for (k = 0; k < v.count[y]; k++) {
+            const uint8_t* src = resample_cache_get(&cache, fetch, arg, v.start[y] + k);
+            vacc(acc, src, in_w, wv[k], k == 0);
+        }
+
+        // Horizontal: tabela de colunas sobre a linha acumulada
+        for (x = 0; x < out_w; x++) {
+            const uint16_t* wh = h.weight + h.offset[x];
+            const uint16_t* a = acc + h.start[x];
+            uint32_t sum = 1u << 22;
+
+            // Máximo 32768 * 65280 + 2^22, ainda dentro de 32 bits
+            for (k = 0; k < h.count[x]; k++) sum += (uint32_t)wh[k] * a[k];
+            out[x] = (uint8_t)(sum >> 23);
+        }
+    }
+    ret = 0;
+
+done:
+    free(acc);
+    free(cache.scratch[0]);
+    free(cache.scratch[1]);
+    resample_axis_free(&h);
+    resample_axis_free(&v);
+    return ret;
+}
@@ -0,0 +1,78 @@
+#ifndef RESAMPLE_H
+#define RESAMPLE_H
+#include <stdint.h>
+
+/* ========== REDIMENSIONAMENTO EM ESCALA DE CINZA ==========
+ *
+ * Cada eixo vira uma tabela calculada uma vez: para cada pixel de saída, o
+ * primeiro índice de origem, quantos índices entram e os pesos em ponto
+ * fixo (somando sempre 1.0). O passe vertical acumula linhas inteiras da
+ * origem em 16 bits (vetorizado), com pesos Q8; o horizontal, escalar em
+ * todas as versões, aplica a tabela de colunas, com pesos Q15 em 32 bits, só
+ * nas linhas de saída, então o custo por pixel de origem é uma multiplicação. Fica a no máximo 2 do
+ * resultado exato; o erro maior vem dos pesos Q8 por linha nas reduções
+ * verticais fortes, o preço de acumular em 16 bits.
+ *
+ * out = (sum_h wh * sum_v wv * pixel + 2^22) >> 23
+ */
+#define RESAMPLE_V_ONE 256
+#define RESAMPLE_H_ONE 32768
+
+typedef enum {
+    RESAMPLE_AUTO = 0,      // Média de área ao reduzir, bilinear ao ampliar (por eixo)
+    RESAMPLE_AREA,          // Média ponderada pela área coberta de cada pixel de origem
+    RESAMPLE_BILINEAR,      // Interpolação entre os dois vizinhos pelos centros dos pixels
+    RESAMPLE_NEAREST        // Vizinho mais próximo, src = (dst * in) / out (comportamento original)
+} resample_mode_t;
+
+// Tabela de um eixo
+typedef struct {
+    int out_size;
+    int* start;             // Primeiro índice de origem de cada saída
+    int* count;             // Quantos índices de origem entram
+    int* offset;            // Posição do primeiro peso em weight
+    uint16_t* weight;       // Pesos; os de cada saída somam 'one'
+    int max_count;
+} resample_axis_t;
+
+// Entrega a linha y da origem já em cinza: devolve scratch preenchido ou um
+// ponteiro próprio que continue válido até a próxima chamada
+typedef const uint8_t* (*resample_fetch_fn)(void* arg, int y, uint8_t* scratch);
+
+// acc[x] = (first ? 0 : acc[x]) + weight * src[x], com weight <= RESAMPLE_V_ONE
+typedef void (*resample_vacc_fn)(uint16_t* acc, const uint8_t* src, int width, int weight, int first);
+
+typedef struct {
+    const char* name;
+    resample_vacc_fn vacc;
+} resample_ops_t;
+
+// Converte "auto", "area", "bilinear" ou "nearest" (retorna -1 se inválido)
+int resample_mode_parse(const char* name, resample_mode_t* mode);
+const char* resample_mode_name(resample_mode_t mode);
+
+// RESAMPLE_AUTO resolvido para um eixo de in_size para out_size
+resample_mode_t resample_axis_mode(resample_mode_t mode, int in_size, int out_size);
+
+// Tabela com pesos somando 'one' (RESAMPLE_V_ONE ou RESAMPLE_H_ONE). 0 = sucesso, -1 = falta de memória
+int resample_axis_init(resample_axis_t* axis, resample_mode_t mode, int in_size, int out_size, int one);
+void resample_axis_free(resample_axis_t* axis);
+
+// Redimensiona in_w x in_h para out_w x out_h, pedindo as linhas de origem em
+// ordem crescente (cada uma uma única vez no caso comum). 0 = sucesso, -1 = falta de memória
+int resample_rows(resample_mode_t mode, resample_fetch_fn fetch, void* arg, int in_w, int in_h,
+                  uint8_t* dst, int dst_stride, int out_w, int out_h);
+
+// Nome da implementação do passe vertical (escalar, sse2, avx2 ou neon)
+const char* resample_simd_name(void);
+
+/* ========== IMPLEMENTAÇÕES ========== */
+
+void resample_vacc_c(uint16_t* acc, const uint8_t* src, int width, int weight, int first);
+
+// Retornam NULL quando não foram compiladas ou a CPU não suporta as instruções
+const resample_ops_t* resample_ops_avx2(void);
+const resample_ops_t* resample_ops_sse2(void);
+const resample_ops_t* resample_ops_neon(void);
+
+#endif
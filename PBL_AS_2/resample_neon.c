@@ -0,0 +1,47 @@
+#include <stddef.h>
+#include "resample.h"
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#if defined(__arm__)
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#endif
+
+/* ========== NEON: 16 PIXELS POR ITERAÇÃO ========== */
+
+// O peso pode valer 256, então a multiplicação é feita já em 16 bits (vmovl + vmla)
+static void resample_vacc_neon(uint16_t* acc, const uint8_t* src, int width, int weight, int first) {
+    uint16_t w = (uint16_t)weight;
+    int x;
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        uint8x16_t p = vld1q_u8(src + x);
+        uint16x8_t lo = first ? vdupq_n_u16(0) : vld1q_u16(acc + x);
+        uint16x8_t hi = first ? vdupq_n_u16(0) : vld1q_u16(acc + x + 8);
+
+        vst1q_u16(acc + x, vmlaq_n_u16(lo, vmovl_u8(vget_low_u8(p)), w));
+        vst1q_u16(acc + x + 8, vmlaq_n_u16(hi, vmovl_u8(vget_high_u8(p)), w));
+    }
+    if (x < width) resample_vacc_c(acc + x, src + x, width - x, weight, first);
+}
+
+static const resample_ops_t resample_ops_neon_table = {
+    "neon",
+    resample_vacc_neon
+};
+
+const resample_ops_t* resample_ops_neon(void) {
+#if defined(__arm__)
+    if (!(getauxval(AT_HWCAP) & HWCAP_NEON)) return NULL;
+#endif
+    return &resample_ops_neon_table;
+}
+
+#else
+
+const resample_ops_t* resample_ops_neon(void) {
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,84 @@
+#include <stddef.h>
+#include "resample.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+// Mesmo esquema de luma_x86.c: atributo target por função e escolha em tempo de execução
+#define RESAMPLE_SSE2 __attribute__((target("sse2")))
+#define RESAMPLE_AVX2 __attribute__((target("avx2")))
+
+/* ========== SSE2: 16 PIXELS POR ITERAÇÃO ========== */
+
+// peso * pixel cabe em 16 bits (máximo 256 * 255) e a soma dos pesos de uma saída é 256
+static RESAMPLE_SSE2 void resample_vacc_sse2(uint16_t* acc, const uint8_t* src, int width, int weight, int first) {
+    __m128i zero = _mm_setzero_si128();
+    __m128i w = _mm_set1_epi16((short)weight);
+    int x;
+
+    for (x = 0; x + 16 <= width; x += 16) {
+        __m128i p = _mm_loadu_si128((const __m128i*)(src + x));
+        __m128i lo = _mm_mullo_epi16(_mm_unpacklo_epi8(p, zero), w);
+        __m128i hi = _mm_mullo_epi16(_mm_unpackhi_epi8(p, zero), w);
+
+        if (!first) {
+            lo = _mm_add_epi16(lo, _mm_loadu_si128((const __m128i*)(acc + x)));
+            hi = _mm_add_epi16(hi, _mm_loadu_si128((const __m128i*)(acc + x + 8)));
+        }
+        _mm_storeu_si128((__m128i*)(acc + x), lo);
+        _mm_storeu_si128((__m128i*)(acc + x + 8), hi);
+    }
+    if (x < width) resample_vacc_c(acc + x, src + x, width - x, weight, first);
+}
+
+static const resample_ops_t resample_ops_sse2_table = {
+    "sse2",
+    resample_vacc_sse2
+};
+
+const resample_ops_t* resample_ops_sse2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("sse2") ? &resample_ops_sse2_table : NULL;
+}
+
+/* ========== AVX2: 32 PIXELS POR ITERAÇÃO ========== */
+
+static RESAMPLE_AVX2 void resample_vacc_avx2(uint16_t* acc, const uint8_t* src, int width, int weight, int first) {
+    __m256i w = _mm256_set1_epi16((short)weight);
+    int x;
+
+    for (x = 0; x + 32 <= width; x += 32) {
+        __m256i lo = _mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + x))), w);
+        __m256i hi = _mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(src + x + 16))), w);
+
+        if (!first) {
+            lo = _mm256_add_epi16(lo, _mm256_loadu_si256((const __m256i*)(acc + x)));
+            hi = _mm256_add_epi16(hi, _mm256_loadu_si256((const __m256i*)(acc + x + 16)));
+        }
+        _mm256_storeu_si256((__m256i*)(acc + x), lo);
+        _mm256_storeu_si256((__m256i*)(acc + x + 16), hi);
+    }
+    if (x < width) resample_vacc_sse2(acc + x, src + x, width - x, weight, first);
+}
+
+static const resample_ops_t resample_ops_avx2_table = {
+    "avx2",
+    resample_vacc_avx2
+};
+
+const resample_ops_t* resample_ops_avx2(void) {
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") ? &resample_ops_avx2_table : NULL;
+}
+
+#else
+
+const resample_ops_t* resample_ops_sse2(void) {
+    return NULL;
+}
+
+const resample_ops_t* resample_ops_avx2(void) {
+    return NULL;
+}
+
+#endif
@@ -0,0 +1,153 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "frame_ring.h"
+
+/* ========== PRODUTOR DE TESTE PARA O MODO -m ==========
+ *
+ * Cria o anel de entrada e publica quadros sintéticos (um padrão que se
+ * desloca a cada quadro) o mais rápido possível ou na taxa pedida. Com -M,
+ * uma segunda thread consome o anel de saída do ./main e mede a taxa e a
+ * latência de ponta a ponta (publicação na entrada até a leitura na saída).
+ *
+ *   ./ring_producer -n 2000 -M /pbl_saida &  ./main -m /pbl_entrada -M /pbl_saida
+ */
+
+typedef struct {
+    const char* name;
+    long frames;
+    double seconds;
+    double latency_ms;          // Média
+    double latency_max_ms;
+} drain_t;
+
+static double elapsed_s(uint64_t since) {
+    return (frame_ring_now_ns() - since) / 1e9;
+}
+
+// Consome o anel de saída assim que o ./main o criar
+static void* drain_output(void* data) {
+    drain_t* d = data;
+    frame_ring_t ring;
+    frame_ring_frame_t f;
+    uint64_t start = 0, sum = 0, max = 0, lat;
+    struct timespec wait = { 0, 10 * 1000 * 1000 };
+
+    while (frame_ring_open(&ring, d->name) != 0) nanosleep(&wait, NULL);
+    while (frame_ring_begin_read(&ring, &f) == 0) {
+        lat = frame_ring_now_ns() - f.timestamp_ns;
+        if (d->frames++ == 0) start = frame_ring_now_ns();
+        sum += lat;
+        if (lat > max) max = lat;
+        frame_ring_end_read(&ring);
+    }
+    d->seconds = d->frames ? elapsed_s(start) : 0.0;
+    d->latency_ms = d->frames ? sum / 1e6 / d->frames : 0.0;
+    d->latency_max_ms = max / 1e6;
+    frame_ring_unmap(&ring);
+    return NULL;
+}
+
+static void print_usage(const char* program) {
+    printf("Uso: %s [-m anel] [-M anel_saída] [-g LxA] [-n quadros] [-s quadros_por_anel] [-r fps]\n", program);
+    printf("  -m  anel criado para o ./main -m (padrão: /pbl_entrada)\n");
+    printf("  -M  anel de saída do ./main -M para consumir e medir a latência\n");
+    printf("  -g  dimensões dos quadros (padrão: 640x480)\n");
+    printf("  -n  quadros publicados (padrão: 1000)\n");
+    printf("  -s  quadros no anel, potência de 2 (padrão: %d)\n", FRAME_RING_SLOTS_DEFAULT);
+    printf("  -r  quadros por segundo, 0 = o mais rápido possível (padrão: 0)\n");
+}
+
+int main(int argc, char** argv) {
+    const char* name = "/pbl_entrada";
+    int width = 640, height = 480, slots = FRAME_RING_SLOTS_DEFAULT, opt, y;
+    long frames = 1000, n;
+    double fps = 0.0;
+    drain_t drain;
+    pthread_t drainer;
+    frame_ring_t ring;
+    frame_ring_frame_t f;
+    uint8_t* pattern;
+    uint64_t start;
+    int x;
+
+    memset(&drain, 0, sizeof(drain));
+    while ((opt = getopt(argc, argv, "m:M:g:n:s:r:h")) != -1) {
+        switch (opt) {
+            case 'm': name = optarg; break;
+            case 'M': drain.name = optarg; break;
+            case 'g':
+                if (sscanf(optarg, "%dx%d", &width, &height) != 2 || width <= 0 || height <= 0) {
+                    fprintf(stderr, "Dimensões inválidas: %s\n", optarg);
+                    return EXIT_FAILURE;
+                }
+                break;
+            case 'n': frames = atol(optarg); break;
+            case 's': slots = atoi(optarg); break;
+            case 'r': fps = atof(optarg); break;
+            default:
+                print_usage(argv[0]);
+                return (opt == 'h') ? EXIT_SUCCESS : EXIT_FAILURE;
+        }
+    }
+
+    // Duas larguras do padrão: cada linha do quadro é uma janela deslocada dele
+    pattern = (uint8_t*)malloc((size_t)width * 2);
+    if (!pattern) return EXIT_FAILURE;
+    for (x = 0; x < width * 2; x++) pattern[x] = (uint8_t)((x * 7) ^ (x >> 3));
+
+    if (frame_ring_create(&ring, name, width, height, slots) != 0) {
+        fprintf(stderr, "Erro ao criar o anel %s (quadros por anel: potência de 2 até %d)\n", name, FRAME_RING_MAX_SLOTS);
+        free(pattern);
+        return EXIT_FAILURE;
+    }
+    // Um anel de saída de uma execução anterior não pode ser confundido com o novo
+    if (drain.name) {
+        frame_ring_unlink(drain.name);
+        if (pthread_create(&drainer, NULL, drain_output, &drain) != 0) drain.name = NULL;
+    }
+    printf("Anel %s: %dx%d, %d quadros; publicando %ld quadros\n", name, width, height, slots, frames);
+
+    start = frame_ring_now_ns();
+    for (n = 0; n < frames; n++) {
+        if (fps > 0) {
+            uint64_t due = start + (uint64_t)(n * 1e9 / fps);
+            uint64_t now = frame_ring_now_ns();
+
+            if (due > now) {
+                struct timespec t = { (time_t)((due - now) / 1000000000u), (long)((due - now) % 1000000000u) };
+                nanosleep(&t, NULL);
+            }
+        }
+        frame_ring_begin_write(&ring, &f, 1);
+        for (y = 0; y < height; y++) {
+            memcpy(image_row(&f.img, y), pattern + (n + y) % width, (size_t)width);
+        }
+        f.sequence = (uint32_t)n;
+        f.timestamp_ns = frame_ring_now_ns();
+        frame_ring_end_write(&ring, &f);
+    }
+    frame_ring_close(&ring);
+    printf("Publicados: %ld quadros em %.2f s (%.1f fps)\n", frames, elapsed_s(start),
+           frames / elapsed_s(start));
+    // O anel só some depois que o ./main pegou todos os quadros
+    while (frame_ring_pending(&ring) > 0) {
+        struct timespec t = { 0, 1000 * 1000 };
+
+        nanosleep(&t, NULL);
+    }
+
+    if (drain.name) {
+        pthread_join(drainer, NULL);
+        printf("Recebidos de %s: %ld quadros, %.1f fps, latência média %.2f ms, máxima %.2f ms\n", drain.name,
+               drain.frames, drain.seconds > 0 ? (drain.frames - 1) / drain.seconds : 0.0,
+               drain.latency_ms, drain.latency_max_ms);
+    }
+    frame_ring_unmap(&ring);
+    frame_ring_unlink(name);
+    free(pattern);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,129 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+struct thread_pool {
+    pthread_mutex_t lock;
+    pthread_cond_t work_ready;      // Sinaliza um novo lote de tarefas (ou encerramento)
+    pthread_cond_t work_done;       // Sinaliza que o lote atual terminou
+    pthread_t* workers;
+    int nworkers;                   // Threads auxiliares (sem contar quem chama run)
+    thread_pool_fn fn;
+    void* arg;
+    int count;                      // Tarefas do lote atual
+    int next;                       // Próxima tarefa a ser retirada
+    int pending;                    // Tarefas ainda não concluídas
+    unsigned generation;            // Incrementado a cada lote
+    int shutdown;
+};
+
+// Retira e executa tarefas do lote atual até acabar (chamada com o lock preso)
+static void thread_pool_drain(thread_pool_t* pool) {
+    while (pool->next < pool->count) {
+        int index = pool->next++;
+        thread_pool_fn fn = pool->fn;
+        void* arg = pool->arg;
+
+        pthread_mutex_unlock(&pool->lock);
+        fn(arg, index);
+        pthread_mutex_lock(&pool->lock);
+
+        if (--pool->pending == 0) {
+            pthread_cond_broadcast(&pool->work_done);
+        }
+    }
+}
+
+static void* thread_pool_worker(void* data) {
+    thread_pool_t* pool = data;
+    unsigned seen = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    while (1) {
+        while (!pool->shutdown && pool->generation == seen) {
+            pthread_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        seen = pool->generation;
+        thread_pool_drain(pool);
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+thread_pool_t* thread_pool_create(int threads) {
+    thread_pool_t* pool;
+    int i;
+
+    if (threads <= 0) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        threads = (online > 0) ? (int)online : 1;
+    }
+
+    pool = calloc(1, sizeof(*pool));
+    if (!pool) return NULL;
+    pool->workers = calloc((size_t)threads, sizeof(pthread_t));
+    if (!pool->workers) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work_ready, NULL);
+    pthread_cond_init(&pool->work_done, NULL);
+
+    for (i = 0; i < threads - 1; i++) {
+        if (pthread_create(&pool->workers[i], NULL, thread_pool_worker, pool) != 0) break;
+        pool->nworkers++;
+    }
+    return pool;
+}
+
+int thread_pool_size(const thread_pool_t* pool) {
+    return pool ? pool->nworkers + 1 : 1;
+}
+
+void thread_pool_run(thread_pool_t* pool, thread_pool_fn fn, void* arg, int count) {
+    int i;
+
+    // Sem pool (ou sem auxiliares) as tarefas rodam em sequência na própria thread
+    if (!pool || pool->nworkers == 0) {
+        for (i = 0; i < count; i++) fn(arg, i);
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->count = count;
+    pool->next = 0;
+    pool->pending = count;
+    pool->generation++;
+    pthread_cond_broadcast(&pool->work_ready);
+
+    // Quem chama também trabalha e depois espera as tarefas em andamento
+    thread_pool_drain(pool);
+    while (pool->pending > 0) {
+        pthread_cond_wait(&pool->work_done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+void thread_pool_destroy(thread_pool_t* pool) {
+    int i;
+
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->work_ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (i = 0; i < pool->nworkers; i++) {
+        pthread_join(pool->workers[i], NULL);
+    }
+    pthread_cond_destroy(&pool->work_ready);
+    pthread_cond_destroy(&pool->work_done);
+    pthread_mutex_destroy(&pool->lock);
+    free(pool->workers);
+    free(pool);
+}
@@ -0,0 +1,23 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/* ========== POOL PERSISTENTE DE THREADS ========== */
+
+// Tarefa executada para cada índice em [0, count)
+typedef void (*thread_pool_fn)(void* arg, int index);
+
+typedef struct thread_pool thread_pool_t;
+
+// Cria o pool com 'threads' threads no total (a thread que chama conta como uma).
+// threads <= 0 usa o número de núcleos online.
+thread_pool_t* thread_pool_create(int threads);
+
+// Número de threads que executam tarefas (incluindo a que chama thread_pool_run)
+int thread_pool_size(const thread_pool_t* pool);
+
+// Distribui fn(arg, 0..count-1) entre as threads e só retorna quando todas terminam
+void thread_pool_run(thread_pool_t* pool, thread_pool_fn fn, void* arg, int count);
+
+void thread_pool_destroy(thread_pool_t* pool);
+
+#endif
@@ -0,0 +1,400 @@
+// Sequências longas passam de 2 GB também no ARM de 32 bits
+#define _FILE_OFFSET_BITS 64
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "video.h"
+
+/* ========== LEITURA ========== */
+
+// Bytes de croma por quadro para os espaços de cor Y4M de 8 bits
+static int video_chroma_bytes(const char* cs, int w, int h, size_t* bytes) {
+    size_t cw2 = (size_t)(w + 1) / 2, ch2 = (size_t)(h + 1) / 2;
+
+    if (strcmp(cs, "420") == 0 || strcmp(cs, "420jpeg") == 0 || strcmp(cs, "420paldv") == 0 ||
+        strcmp(cs, "420mpeg2") == 0) *bytes = 2 * cw2 * ch2;
+    else if (strcmp(cs, "422") == 0) *bytes = 2 * cw2 * (size_t)h;
+    else if (strcmp(cs, "444") == 0) *bytes = 2 * (size_t)w * h;
+    else if (strcmp(cs, "444alpha") == 0) *bytes = 3 * (size_t)w * h;
+    else if (strcmp(cs, "411") == 0) *bytes = 2 * ((size_t)(w + 3) / 4) * h;
+    else if (strcmp(cs, "mono") == 0) *bytes = 0;
+    else return -1;     // Profundidades acima de 8 bits não são aceitas
+    return 0;
+}
+
+// Cabeçalho "YUV4MPEG2 W<w> H<h> F<n>:<d> ... C<cs>" terminado em '\n'
+static int video_read_y4m_header(video_in_t* v) {
+    char line[256], cs[32] = "420jpeg";
+    char* tok;
+    char* save;
+
+    if (!fgets(line, sizeof(line), v->f) || strncmp(line, "YUV4MPEG2 ", 10) != 0) return -1;
+    if (!strchr(line, '\n')) return -1;
+    v->width = v->height = 0;
+    for (tok = strtok_r(line + 10, " \n", &save); tok; tok = strtok_r(NULL, " \n", &save)) {
+        switch (tok[0]) {
+            case 'W': v->width = atoi(tok + 1); break;
+            case 'H': v->height = atoi(tok + 1); break;
+            case 'F': sscanf(tok + 1, "%d:%d", &v->fps_num, &v->fps_den); break;
+            case 'C': snprintf(cs, sizeof(cs), "%s", tok + 1); break;
+            default: break;   // Entrelaçamento, aspecto e extensões não mudam o plano Y
+        }
+    }
+    if (v->width <= 0 || v->height <= 0) return -1;
+    return video_chroma_bytes(cs, v->width, v->height, &v->skip);
+}
+
+int video_open_read(video_in_t* v, const char* path, int raw_width, int raw_height) {
+    struct stat st;
+
+    memset(v, 0, sizeof(*v));
+    v->f = (strcmp(path, "-") == 0) ? stdin : fopen(path, "rb");
+    if (!v->f) return -1;
+    v->live = (fstat(fileno(v->f), &st) == 0 && !S_ISREG(st.st_mode));
+
+    if (raw_width > 0 && raw_height > 0) {
+        v->width = raw_width;
+        v->height = raw_height;
+        return 0;
+    }
+    v->y4m = 1;
+    if (video_read_y4m_header(v) != 0) {
+        video_close_read(v);
+        return -1;
+    }
+    return 0;
+}
+
+int video_read_frame(video_in_t* v, image_t* frame) {
+    size_t row_bytes = (size_t)v->width;
+    size_t skip = v->skip;
+    char buf[4096];
+    int c, y;
+
+    if (v->y4m) {
+        // "FRAME" com parâmetros opcionais até o fim da linha
+        if (fread(buf, 1, 5, v->f) != 5) return feof(v->f) ? 1 : -1;
+        if (memcmp(buf, "FRAME", 5) != 0) return -1;
+        while ((c = fgetc(v->f)) != '\n') {
+            if (c == EOF) return -1;
+        }
+    }
+    for (y = 0; y < v->height; y++) {
+        if (fread(image_row(frame, y), 1, row_bytes, v->f) != row_bytes) {
+            // Fim limpo só antes do primeiro byte de um quadro raw
+            return (!v->y4m && y == 0 && feof(v->f)) ? 1 : -1;
+        }
+    }
+    // O croma é lido e jogado fora, para funcionar também com pipes
+    while (skip > 0) {
+        size_t n = skip < sizeof(buf) ? skip : sizeof(buf);
+
+        if (fread(buf, 1, n, v->f) != n) return -1;
+        skip -= n;
+    }
+    return 0;
+}
+
+void video_close_read(video_in_t* v) {
+    if (v->f && v->f != stdin) fclose(v->f);
+    v->f = NULL;
+}
+
+/* ========== GRAVAÇÃO ========== */
+
+int video_open_write(video_out_t* v, const char* path, int y4m, int width, int height, int fps_num, int fps_den) {
+    memset(v, 0, sizeof(*v));
+    v->width = width;
+    v->height = height;
+    v->y4m = y4m;
+    if (!path) return 0;
+
+    v->f = (strcmp(path, "-") == 0) ? stdout : fopen(path, "wb");
+    if (!v->f) return -1;
+    if (fps_num <= 0 || fps_den <= 0) {
+        fps_num = 25;
+        fps_den = 1;
+    }
+    if (y4m && fprintf(v->f, "YUV4MPEG2 W%d H%d F%d:%d Ip A1:1 Cmono\n", width, height, fps_num, fps_den) < 0) {
+        video_close_write(v);
+        return -1;
+    }
+    return 0;
+}
+
+int video_write_frame(video_out_t* v, const image_t* frame) {
+    size_t row_bytes = (size_t)v->width;
+    int y;
+
+    if (!v->f) return 0;
+    if (v->y4m && fputs("FRAME\n", v->f) < 0) return -1;
+    for (y = 0; y < v->height; y++) {
+        if (fwrite(image_row(frame, y), 1, row_bytes, v->f) != row_bytes) return -1;
+    }
+    return 0;
+}
+
+int video_close_write(video_out_t* v) {
+    int ret = 0;
+
+    if (v->f) {
+        if (v->f == stdout) ret = fflush(stdout);
+        else ret = fclose(v->f);
+    }
+    v->f = NULL;
+    return ret == 0 ? 0 : -1;
+}
+
+/* ========== PROCESSAMENTO CONTÍNUO ========== */
+
+enum { VIDEO_SLOT_FREE = 0, VIDEO_SLOT_BUSY, VIDEO_SLOT_READY };
+
+typedef struct {
+    pthread_mutex_t lock;
+    pthread_cond_t changed;             // Qualquer mudança de estado (poucas threads, broadcast basta)
+    video_in_t* in;
+    video_out_t* out;
+    image_t in_frame[VIDEO_IN_SLOTS];
+    int in_state[VIDEO_IN_SLOTS];
+    int ready;                          // Quadro lido esperando o filtro (-1 = nenhum)
+    image_t out_frame[VIDEO_OUT_SLOTS];
+    int out_state[VIDEO_OUT_SLOTS];
+    int out_queue[VIDEO_OUT_SLOTS];     // Quadros filtrados na ordem de gravação
+    int out_head, out_count;
+    int eof;                            // Leitor terminou (fim ou erro)
+    int filtered_all;                   // Filtro terminou: o gravador sai ao esvaziar a fila
+    int error;
+    int stop;
+    long frames_read, frames_dropped, frames_written;
+    struct timespec start;
+    int started;
+} video_pipe_t;
+
+static double video_elapsed(const struct timespec* a) {
+    struct timespec b;
+
+    clock_gettime(CLOCK_MONOTONIC, &b);
+    return (double)(b.tv_sec - a->tv_sec) + (double)(b.tv_nsec - a->tv_nsec) / 1e9;
+}
+
+static void* video_reader(void* data) {
+    video_pipe_t* p = data;
+    int slot, i, r, old;
+
+    // Só a leitura pode ser cancelada: fora dela o leitor segura o lock ou espera na condição
+    pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old);
+    while (1) {
+        pthread_mutex_lock(&p->lock);
+        slot = -1;
+        while (!p->stop) {
+            for (i = 0; i < VIDEO_IN_SLOTS && slot < 0; i++) {
+                if (p->in_state[i] == VIDEO_SLOT_FREE) slot = i;
+            }
+            if (slot >= 0) break;
+            pthread_cond_wait(&p->changed, &p->lock);
+        }
+        if (p->stop) {
+            pthread_mutex_unlock(&p->lock);
+            break;
+        }
+        p->in_state[slot] = VIDEO_SLOT_BUSY;
+        pthread_mutex_unlock(&p->lock);
+
+        pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, &old);
+        r = video_read_frame(p->in, &p->in_frame[slot]);
+        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, &old);
+
+        pthread_mutex_lock(&p->lock);
+        if (r != 0) {
+            p->in_state[slot] = VIDEO_SLOT_FREE;
+            if (r < 0) p->error = 1;
+            p->eof = 1;
+            pthread_cond_broadcast(&p->changed);
+            pthread_mutex_unlock(&p->lock);
+            break;
+        }
+        if (!p->started) {
+            clock_gettime(CLOCK_MONOTONIC, &p->start);
+            p->started = 1;
+        }
+        p->frames_read++;
+        if (p->ready >= 0 && p->in->live) {
+            // Ao vivo o quadro mais novo vence: o que ainda esperava o filtro é descartado
+            p->in_state[p->ready] = VIDEO_SLOT_FREE;
+            p->ready = -1;
+            p->frames_dropped++;
+        }
+        while (p->ready >= 0 && !p->stop) {
+            pthread_cond_wait(&p->changed, &p->lock);
+        }
+        p->ready = slot;
+        p->in_state[slot] = VIDEO_SLOT_READY;
+        pthread_cond_broadcast(&p->changed);
+        pthread_mutex_unlock(&p->lock);
+    }
+    return NULL;
+}
+
+static void* video_writer(void* data) {
+    video_pipe_t* p = data;
+    int slot, r;
+
+    while (1) {
+        pthread_mutex_lock(&p->lock);
+        while (p->out_count == 0 && !p->filtered_all) {
+            pthread_cond_wait(&p->changed, &p->lock);
+        }
+        if (p->out_count == 0) {
+            pthread_mutex_unlock(&p->lock);
+            break;
+        }
+        slot = p->out_queue[p->out_head];
+        pthread_mutex_unlock(&p->lock);
+
+        r = video_write_frame(p->out, &p->out_frame[slot]);
+
+        pthread_mutex_lock(&p->lock);
+        p->out_head = (p->out_head + 1) % VIDEO_OUT_SLOTS;
+        p->out_count--;
+        p->out_state[slot] = VIDEO_SLOT_FREE;
+        if (r != 0) {
+            p->error = 1;
+            p->stop = 1;
+        } else {
+            p->frames_written++;
+        }
+        pthread_cond_broadcast(&p->changed);
+        pthread_mutex_unlock(&p->lock);
+    }
+    return NULL;
+}
+
+static void video_report(video_pipe_t* p, const char* prefix) {
+    double t = p->started ? video_elapsed(&p->start) : 0.0;
+
+    fprintf(stderr, "%squadros: %ld gravados, %ld descartados, %.1f fps\n", prefix,
+            p->frames_written, p->frames_dropped, t > 0 ? p->frames_written / t : 0.0);
+}
+
+int video_run(video_in_t* in, video_out_t* out, video_process_fn process, void* arg, video_stats_t* stats) {
+    video_pipe_t p;
+    pthread_t reader, writer;
+    struct timespec last;
+    int i, in_slot, out_slot, r, status = 0;
+
+    memset(&p, 0, sizeof(p));
+    p.in = in;
+    p.out = out;
+    p.ready = -1;
+    for (i = 0; i < VIDEO_IN_SLOTS; i++) {
+        if (image_alloc(&p.in_frame[i], in->width, in->height, 1) != 0) status = -1;
+    }
+    for (i = 0; i < VIDEO_OUT_SLOTS; i++) {
+        if (image_alloc(&p.out_frame[i], in->width, in->height, 1) != 0) status = -1;
+    }
+    if (status != 0) goto done;
+
+    pthread_mutex_init(&p.lock, NULL);
+    pthread_cond_init(&p.changed, NULL);
+    if (pthread_create(&reader, NULL, video_reader, &p) != 0) {
+        status = -1;
+        goto destroy;
+    }
+    if (pthread_create(&writer, NULL, video_writer, &p) != 0) {
+        pthread_mutex_lock(&p.lock);
+        p.stop = 1;
+        pthread_cond_broadcast(&p.changed);
+        pthread_mutex_unlock(&p.lock);
+        pthread_join(reader, NULL);
+        status = -1;
+        goto destroy;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &last);
+
+    // A thread que chama filtra: pega o quadro pronto e um buffer de saída livre
+    while (1) {
+        pthread_mutex_lock(&p.lock);
+        while (p.ready < 0 && !p.eof && !p.stop) {
+            pthread_cond_wait(&p.changed, &p.lock);
+        }
+        if (p.ready < 0 || p.stop) {
+            pthread_mutex_unlock(&p.lock);
+            break;
+        }
+        in_slot = p.ready;
+        p.ready = -1;
+        p.in_state[in_slot] = VIDEO_SLOT_BUSY;
+        pthread_cond_broadcast(&p.changed);
+
+        out_slot = -1;
+        while (!p.stop) {
+            for (i = 0; i < VIDEO_OUT_SLOTS && out_slot < 0; i++) {
+                if (p.out_state[i] == VIDEO_SLOT_FREE) out_slot = i;
+            }
+            if (out_slot >= 0) break;
+            pthread_cond_wait(&p.changed, &p.lock);
+        }
+        if (p.stop) {
+            pthread_mutex_unlock(&p.lock);
+            break;
+        }
+        p.out_state[out_slot] = VIDEO_SLOT_BUSY;
+        pthread_mutex_unlock(&p.lock);
+
+        r = process(arg, &p.in_frame[in_slot], &p.out_frame[out_slot]);
+
+        pthread_mutex_lock(&p.lock);
+        p.in_state[in_slot] = VIDEO_SLOT_FREE;
+        if (r != 0) {
+            p.out_state[out_slot] = VIDEO_SLOT_FREE;
+            p.error = 1;
+            p.stop = 1;
+        } else {
+            p.out_queue[(p.out_head + p.out_count) % VIDEO_OUT_SLOTS] = out_slot;
+            p.out_count++;
+        }
+        pthread_cond_broadcast(&p.changed);
+        if (video_elapsed(&last) >= 1.0) {
+            video_report(&p, "");
+            clock_gettime(CLOCK_MONOTONIC, &last);
+        }
+        pthread_mutex_unlock(&p.lock);
+    }
+
+    pthread_mutex_lock(&p.lock);
+    p.filtered_all = 1;
+    p.stop = p.stop || p.error;
+    pthread_cond_broadcast(&p.changed);
+    pthread_mutex_unlock(&p.lock);
+    pthread_join(writer, NULL);
+
+    // Com a saída encerrada o leitor não tem mais para quem entregar. Num erro ele
+    // pode estar parado no fread de um pipe ao vivo sem dados: é cancelado ali
+    pthread_mutex_lock(&p.lock);
+    p.stop = 1;
+    if (p.error && !p.eof) pthread_cancel(reader);
+    pthread_cond_broadcast(&p.changed);
+    pthread_mutex_unlock(&p.lock);
+    pthread_join(reader, NULL);
+
+    video_report(&p, "Total: ");
+    if (stats) {
+        stats->frames_read = p.frames_read;
+        stats->frames_dropped = p.frames_dropped;
+        stats->frames_written = p.frames_written;
+        stats->seconds = p.started ? video_elapsed(&p.start) : 0.0;
+        stats->fps = stats->seconds > 0 ? p.frames_written / stats->seconds : 0.0;
+    }
+    status = p.error ? -1 : 0;
+
+destroy:
+    pthread_mutex_destroy(&p.lock);
+    pthread_cond_destroy(&p.changed);
+done:
+    for (i = 0; i < VIDEO_IN_SLOTS; i++) image_free(&p.in_frame[i]);
+    for (i = 0; i < VIDEO_OUT_SLOTS; i++) image_free(&p.out_frame[i]);
+    return status;
+}
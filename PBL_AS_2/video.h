@@ -0,0 +1,68 @@
+#ifndef VIDEO_H
+#define VIDEO_H
+#include <stdio.h>
+#include <stdint.h>
+#include "image.h"
+
+/* ========== SEQUÊNCIAS DE QUADROS (Y4M OU RAW) ==========
+ *
+ * Entrada Y4M (só o plano Y é usado; o croma é lido e descartado) ou raw
+ * com quadros de width * height bytes seguidos. Arquivo ou pipe ("-" é a
+ * entrada/saída padrão). A saída é Y4M monocromático ou raw.
+ */
+
+// Quadros na mão de cada etapa: um sendo lido, um pronto e um sendo filtrado;
+// na saída, um sendo preenchido e um sendo gravado
+#define VIDEO_IN_SLOTS 3
+#define VIDEO_OUT_SLOTS 2
+
+typedef struct {
+    FILE* f;
+    int width;
+    int height;
+    int y4m;
+    size_t skip;            // Bytes de croma depois de cada plano Y
+    int fps_num, fps_den;   // Taxa declarada (Y4M); 0 quando desconhecida
+    int live;               // Pipe ou dispositivo: quadros atrasados são descartados
+} video_in_t;
+
+typedef struct {
+    FILE* f;                // NULL = descarta os quadros (só mede)
+    int width;
+    int height;
+    int y4m;
+} video_out_t;
+
+// raw_width/raw_height > 0 abre um raw com essas dimensões; senão lê o cabeçalho Y4M.
+// 0 = sucesso, -1 = erro
+int video_open_read(video_in_t* v, const char* path, int raw_width, int raw_height);
+// 0 = quadro lido, 1 = fim da sequência, -1 = erro
+int video_read_frame(video_in_t* v, image_t* frame);
+void video_close_read(video_in_t* v);
+
+// path NULL descarta a saída; fps_num 0 grava F25:1 no cabeçalho Y4M
+int video_open_write(video_out_t* v, const char* path, int y4m, int width, int height, int fps_num, int fps_den);
+int video_write_frame(video_out_t* v, const image_t* frame);
+int video_close_write(video_out_t* v);
+
+/* ========== PROCESSAMENTO CONTÍNUO ========== */
+
+// Filtra in em out (mesmas dimensões). 0 = sucesso
+typedef int (*video_process_fn)(void* arg, const image_t* in, image_t* out);
+
+typedef struct {
+    long frames_read;
+    long frames_dropped;    // Lidos mas substituídos por um mais novo antes de filtrar
+    long frames_written;
+    double seconds;
+    double fps;             // Quadros gravados por segundo, do primeiro quadro ao fim
+} video_stats_t;
+
+// Lê, filtra e grava em três threads: enquanto o quadro N é filtrado, o N+1 é lido
+// e o N-1 gravado. Com entrada ao vivo (live) o leitor nunca espera: se o filtro não
+// acompanha, o quadro pronto mais antigo é descartado. Mostra o andamento em stderr
+// a cada segundo. Num erro de gravação ou do filtro o leitor é cancelado, sem esperar
+// o próximo quadro. 0 = sucesso, -1 = erro de leitura, gravação ou memória
+int video_run(video_in_t* in, video_out_t* out, video_process_fn process, void* arg, video_stats_t* stats);
+
+#endif